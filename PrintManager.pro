@@ -1,16 +1,37 @@
 QT += core widgets
 QT -= gui
 
-CONFIG += c++17
+CONFIG += c++17 thread
+
+# 运行时指标：改为 PRINTMANAGER_METRICS=0 可在编译期去掉全部埋点
+DEFINES += PRINTMANAGER_METRICS=1
 
 TARGET = PrintManagerGUI
 TEMPLATE = app
 
 SOURCES += \
     src/main_gui.cpp \
-    src/mainwindow.cpp
+    src/mainwindow.cpp \
+    src/jobtablemodel.cpp
 
 HEADERS += \
     src/mainwindow.h \
-    src/printmanager.h
+    src/jobtablemodel.h \
+    src/printmanager.h \
+    src/simtime.h \
+    src/journal.h \
+    src/csvreader.h \
+    src/jobqueue.h \
+    src/stats.h \
+    src/stringpool.h \
+    src/donelog.h \
+    src/donestore.h \
+    src/metrics.h \
+    src/idallocator.h \
+    src/shardedmanager.h \
+    src/ipc.h \
+    src/workload.h \
+    src/sweep.h \
+    src/simworker.h \
+    src/mpscqueue.h
 
@@ -0,0 +1,364 @@
+// PrintManager 引擎的性能基准：对热点操作测量 ns/op、每次操作的内存分配次数和写盘字节数。
+// 不依赖第三方库；输出格式仿照 Google Benchmark，--csv 时输出便于比对的 CSV。
+//
+// 用法: PrintManagerBench [--filter 子串] [--max N] [--max-persist N] [--csv]
+//   --max          不写文件时的最大队列规模（默认 1000000）
+//   --max-persist  写文件时的最大队列规模（默认 100000；每 10000 个事件一次完整快照，
+//                  规模再大时单次运行耗时以分钟计）
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "printmanager.h"
+#include "shardedmanager.h"
+
+// ========== 内存分配计数 ==========
+
+static std::atomic<unsigned long long> g_allocs{0};
+
+void* operator new(std::size_t n)
+{
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+// ========== 测量 ==========
+
+static const char* kDataDir = "bench_data";
+
+struct Result {
+    std::string name;
+    size_t size = 0;
+    bool persist = false;
+    long long ops = 0;
+    double nsPerOp = 0.0;
+    double allocsPerOp = 0.0;
+    double bytesPerOp = 0.0;
+};
+
+// 新建一个引擎；persist 时所有文件写到 bench_data/ 下
+static void configure(PrintManager& pm, bool persist)
+{
+    pm.persist = persist;
+    if (persist) {   // 每个用例从空目录开始，完成日志不会接着上一个用例追加
+        std::error_code ec;
+        std::filesystem::remove_all(kDataDir, ec);
+        std::filesystem::create_directories(kDataDir);
+    }
+    pm.setDataDir(kDataDir);
+    pm.journal.durability = Journal::Durability::OnShutdown;   // 只测写入量，不测磁盘 fsync 延迟
+    if (persist) pm.saveAll();
+}
+
+static void fill(PrintManager& pm, size_t n)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pages(1, 50);
+    std::uniform_int_distribution<int> prio(0, 9);
+    for (size_t i = 0; i < n; ++i) {
+        pm.addJob("user" + std::to_string(i % 100), "doc" + std::to_string(i), pages(rng), prio(rng));
+    }
+}
+
+static unsigned long long bytesOf(const PrintManager& pm)
+{
+    return pm.journal.bytesWritten + pm.journal.buf.size() + pm.snapshotBytes + pm.doneLog.bytesWritten;
+}
+
+// 计时 body()；它执行 ops 次被测操作
+static Result measure(const std::string& name, size_t size, PrintManager& pm, long long ops,
+                      const std::function<void()>& body)
+{
+    Result r;
+    r.name = name;
+    r.size = size;
+    r.persist = pm.persist;
+    r.ops = ops;
+    unsigned long long bytes0 = bytesOf(pm);
+    unsigned long long allocs0 = g_allocs.load();
+    auto t0 = std::chrono::steady_clock::now();
+    body();
+    auto t1 = std::chrono::steady_clock::now();
+    unsigned long long allocs1 = g_allocs.load();
+    pm.journal.flush(false);
+    pm.doneLog.flush(false);
+    double d = (double)std::max(1LL, ops);
+    r.nsPerOp = std::chrono::duration<double, std::nano>(t1 - t0).count() / d;
+    r.allocsPerOp = (allocs1 - allocs0) / d;
+    r.bytesPerOp = (bytesOf(pm) - bytes0) / d;
+    return r;
+}
+
+// 重复次数：小队列多跑几次，使总耗时可测
+static long long repeatsFor(size_t n, long long budget)
+{
+    return std::max(1LL, budget / (long long)std::max<size_t>(n, 1));
+}
+
+// ========== 基准 ==========
+
+static Result benchAddJob(size_t n, bool persist)
+{
+    PrintManager pm;
+    configure(pm, persist);
+    return measure("addJob", n, pm, (long long)n, [&]() { fill(pm, n); });
+}
+
+// 同一批任务用 addJobs 一次提交（用户名/文档名事先放进字符串池）
+static Result benchAddJobs(size_t n, bool persist)
+{
+    PrintManager pm;
+    configure(pm, persist);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pages(1, 50);
+    std::uniform_int_distribution<int> prio(0, 9);
+    StringPool& strings = StringPool::global();
+    std::vector<JobSpec> specs(n);
+    for (size_t i = 0; i < n; ++i) {
+        specs[i].user = strings.internUser("user" + std::to_string(i % 100));
+        specs[i].doc = strings.addDoc("doc" + std::to_string(i));
+        specs[i].pages = pages(rng);
+        specs[i].priority = prio(rng);
+    }
+    return measure("addJobs", n, pm, (long long)n, [&]() { pm.addJobs(specs); });
+}
+
+static Result benchCancelJob(size_t n, bool persist)
+{
+    PrintManager pm;
+    configure(pm, persist);
+    fill(pm, n);
+    std::vector<int> ids;
+    for (const auto& j : pm.waitQ) ids.push_back(j.id);
+    std::shuffle(ids.begin(), ids.end(), std::mt19937(7));
+    return measure("cancelJob", n, pm, (long long)n, [&]() {
+        for (int id : ids) pm.cancelJob(id);
+    });
+}
+
+// 按用户批量取消：100 个用户逐个取消，每次扫描一遍队列，ops 为取消的任务数
+static Result benchCancelUserJobs(size_t n, bool persist)
+{
+    PrintManager pm;
+    configure(pm, persist);
+    pm.setDiscipline(QueueDiscipline::Priority);
+    fill(pm, n);
+    return measure("cancelUserJobs", n, pm, (long long)n, [&]() {
+        for (int u = 0; u < 100; ++u) pm.cancelUserJobs("user" + std::to_string(u));
+    });
+}
+
+static Result benchTick(size_t n, bool persist)
+{
+    PrintManager pm;
+    configure(pm, persist);
+    pm.setPrinterCount(4);
+    fill(pm, n);
+    const long long ticks = 10000;
+    return measure("tick", n, pm, ticks, [&]() {
+        for (long long i = 0; i < ticks; ++i) pm.tick(1);
+    });
+}
+
+static Result benchRunToEnd(size_t n, bool persist)
+{
+    PrintManager pm;
+    configure(pm, persist);
+    pm.setPrinterCount(4);
+    fill(pm, n);
+    return measure("runToEnd/job", n, pm, (long long)n, [&]() { pm.runToEnd(); });
+}
+
+static Result benchGetWaitingJobs(size_t n, bool persist)
+{
+    PrintManager pm;
+    configure(pm, persist);
+    fill(pm, n);
+    long long reps = repeatsFor(n, 1000000);
+    size_t sink = 0;
+    Result r = measure("getWaitingJobs", n, pm, reps, [&]() {
+        for (long long i = 0; i < reps; ++i) sink += pm.getWaitingJobs().size();
+    });
+    if (sink == 1) std::puts("");
+    return r;
+}
+
+static Result benchGetStatistics(size_t n, bool persist)
+{
+    PrintManager pm;
+    configure(pm, persist);
+    pm.setPrinterCount(4);
+    fill(pm, n);
+    pm.runToEnd();
+    const long long reps = 100000;
+    double sink = 0;
+    Result r = measure("getStatistics", n, pm, reps, [&]() {
+        for (long long i = 0; i < reps; ++i) sink += pm.getStatistics().avgWaitTime;
+    });
+    if (sink < 0) std::puts("");
+    return r;
+}
+
+static Result benchSaveAll(size_t n, bool persist)
+{
+    PrintManager pm;
+    configure(pm, persist);
+    pm.setPrinterCount(4);
+    fill(pm, n);
+    pm.tick(600);   // 一部分已完成，一部分在打印，其余在等待
+    long long reps = std::min(100LL, repeatsFor(n, 100000));
+    return measure("saveAll", n, pm, reps, [&]() {
+        for (long long i = 0; i < reps; ++i) pm.saveAll();
+    });
+}
+
+// 分片提交：T 个线程各自向自己的分片逐个提交 n / T 个任务（用户名/文档名事先驻留），
+// ns/op 为墙钟时间除以总任务数，理想情况下随 T 成反比下降
+template <int T>
+static Result benchShardedSubmit(size_t n, bool persist)
+{
+    std::vector<ShardConfig> configs(T);
+    std::error_code ec;
+    std::filesystem::remove_all(kDataDir, ec);
+    for (int t = 0; t < T; ++t) {
+        configs[t].name = "site" + std::to_string(t);
+        if (persist) configs[t].dataDir = std::string(kDataDir) + "/" + configs[t].name;
+    }
+    ShardedManager sm(configs);
+    for (int t = 0; t < T; ++t) {
+        sm.with(t, [](PrintManager& pm) { pm.journal.durability = Journal::Durability::OnShutdown; });
+    }
+    StringPool& strings = StringPool::global();
+    std::vector<JobSpec> specs(n);
+    for (size_t i = 0; i < n; ++i) {
+        specs[i].user = strings.internUser("user" + std::to_string(i % 100));
+        specs[i].doc = strings.addDoc("doc" + std::to_string(i));
+        specs[i].pages = 1 + (int)(i % 50);
+    }
+
+    // 与 measure() 相同：各分片写盘字节数之和，结束后先落盘缓冲区再读
+    auto shardBytes = [&sm]() {
+        unsigned long long bytes = 0;
+        for (int t = 0; t < T; ++t) sm.with(t, [&bytes](PrintManager& pm) { bytes += bytesOf(pm); });
+        return bytes;
+    };
+
+    Result r;
+    r.name = "shardedSubmit/T" + std::to_string(T);
+    r.size = n;
+    r.persist = persist;
+    r.ops = (long long)n;
+    unsigned long long bytes0 = shardBytes();
+    unsigned long long allocs0 = g_allocs.load();
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < T; ++t) {
+        pool.emplace_back([&, t]() {
+            for (size_t i = (size_t)t; i < n; i += T) {
+                const JobSpec& s = specs[i];
+                sm.submit((size_t)t, s.user, s.doc, s.pages, s.priority);
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    auto t1 = std::chrono::steady_clock::now();
+    unsigned long long allocs1 = g_allocs.load();
+    for (int t = 0; t < T; ++t) {
+        sm.with(t, [](PrintManager& pm) {
+            pm.journal.flush(false);
+            pm.doneLog.flush(false);
+        });
+    }
+    double d = (double)std::max<size_t>(1, n);
+    r.nsPerOp = std::chrono::duration<double, std::nano>(t1 - t0).count() / d;
+    r.allocsPerOp = (allocs1 - allocs0) / d;
+    r.bytesPerOp = (shardBytes() - bytes0) / d;
+    return r;
+}
+
+// ========== 入口 ==========
+
+int main(int argc, char* argv[])
+{
+    std::string filter;
+    size_t maxSize = 1000000;
+    size_t maxPersist = 100000;
+    bool csv = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--filter" && i + 1 < argc) filter = argv[++i];
+        else if (a == "--max" && i + 1 < argc) maxSize = std::strtoull(argv[++i], nullptr, 10);
+        else if (a == "--max-persist" && i + 1 < argc) maxPersist = std::strtoull(argv[++i], nullptr, 10);
+        else if (a == "--csv") csv = true;
+        else {
+            std::fprintf(stderr, "用法: %s [--filter 子串] [--max N] [--max-persist N] [--csv]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    struct Entry {
+        const char* name;
+        Result (*fn)(size_t, bool);
+    };
+    const Entry benches[] = {
+        {"addJob", benchAddJob},
+        {"addJobs", benchAddJobs},
+        {"cancelJob", benchCancelJob},
+        {"cancelUserJobs", benchCancelUserJobs},
+        {"tick", benchTick},
+        {"runToEnd", benchRunToEnd},
+        {"getWaitingJobs", benchGetWaitingJobs},
+        {"getStatistics", benchGetStatistics},
+        {"saveAll", benchSaveAll},
+        {"shardedSubmit/T1", benchShardedSubmit<1>},
+        {"shardedSubmit/T2", benchShardedSubmit<2>},
+        {"shardedSubmit/T4", benchShardedSubmit<4>},
+        {"shardedSubmit/T8", benchShardedSubmit<8>},
+    };
+    const size_t sizes[] = {10, 100, 1000, 10000, 100000, 1000000};
+
+    std::filesystem::create_directories(kDataDir);
+    if (csv) {
+        std::printf("name,size,persist,ops,ns_per_op,allocs_per_op,bytes_per_op\n");
+    } else {
+        std::printf("%-18s %9s %8s %10s %14s %12s %12s\n",
+                    "Benchmark", "Size", "Persist", "Ops", "ns/op", "allocs/op", "bytes/op");
+        std::printf("%s\n", std::string(89, '-').c_str());
+    }
+    for (const auto& b : benches) {
+        if (!filter.empty() && std::string(b.name).find(filter) == std::string::npos) continue;
+        for (bool persist : {false, true}) {
+            for (size_t n : sizes) {
+                if (n > (persist ? maxPersist : maxSize)) continue;
+                Result r = b.fn(n, persist);
+                if (csv) {
+                    std::printf("%s,%zu,%d,%lld,%.2f,%.3f,%.1f\n", r.name.c_str(), r.size, r.persist ? 1 : 0,
+                                r.ops, r.nsPerOp, r.allocsPerOp, r.bytesPerOp);
+                } else {
+                    std::printf("%-18s %9zu %8s %10lld %14.1f %12.2f %12.1f\n", r.name.c_str(), r.size,
+                                r.persist ? "on" : "off", r.ops, r.nsPerOp, r.allocsPerOp, r.bytesPerOp);
+                }
+                std::fflush(stdout);
+            }
+        }
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(kDataDir, ec);
+    return 0;
+}
@@ -0,0 +1,129 @@
+// IPC 提交接口的本机负载发生器：若干个客户端线程各开一个连接，
+// 每轮流水线发送 --pipeline 条提交请求、一次写出，再读回全部响应。
+// 输出总吞吐量（请求/秒）和每轮往返延迟的 P50/P99。
+//
+// 用法: PrintManagerLoadGen <socket> [--clients N] [--requests N] [--pipeline N] [--users N] [--cancel]
+//   --clients   并发连接数（默认 4）
+//   --requests  每个连接发送的提交请求数（默认 100000）
+//   --pipeline  每轮发送的请求数（默认 256）
+//   --users     用户名个数（默认 100）
+//   --cancel    每轮收到响应后把本轮提交的任务全部取消，队列不会越积越长
+// 服务端用 PrintManagerCLI --serve <socket> 启动。
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ipc.h"
+
+struct ClientResult {
+    long long requests = 0;
+    long long errors = 0;
+    std::vector<double> roundTripUs;
+};
+
+static void runClient(const std::string& path, int index, long long requests, int pipeline, int users,
+                      bool cancel, ClientResult& res)
+{
+    IpcClient client;
+    if (!client.connect(path)) {
+        res.errors = requests;
+        return;
+    }
+    std::vector<std::string> names;
+    for (int u = 0; u < users; ++u) names.push_back("user" + std::to_string(u));
+    std::string doc = "loadgen-" + std::to_string(index);
+    std::vector<int> ids;
+    ids.reserve((size_t)pipeline);
+
+    long long sent = 0;
+    while (sent < requests) {
+        int n = (int)std::min<long long>(pipeline, requests - sent);
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; ++i) {
+            long long k = sent + i;
+            client.submit(names[(size_t)(k % users)], doc, 1 + (int)(k % 20), (int)(k % 10));
+        }
+        if (!client.flush()) {
+            res.errors += requests - sent;
+            return;
+        }
+        ids.clear();
+        ipc::Response r;
+        for (int i = 0; i < n; ++i) {
+            if (!client.receive(r)) {
+                res.errors += requests - sent - i;
+                return;
+            }
+            if (r.status != ipc::Status::Ok) res.errors++;
+            else ids.push_back(r.id);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        res.roundTripUs.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        res.requests += n;
+        sent += n;
+
+        if (cancel && !ids.empty()) {   // 取消请求不计入吞吐量
+            for (int id : ids) client.cancel(id);
+            if (!client.flush()) return;
+            for (size_t i = 0; i < ids.size(); ++i) {
+                if (!client.receive(r)) return;
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::fprintf(stderr, "用法: %s <socket> [--clients N] [--requests N] [--pipeline N] [--users N] [--cancel]\n",
+                     argv[0]);
+        return 1;
+    }
+    std::string path = argv[1];
+    int clients = 4;
+    long long requests = 100000;
+    int pipeline = 256;
+    int users = 100;
+    bool cancel = false;
+    for (int i = 2; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--clients" && i + 1 < argc) clients = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--requests" && i + 1 < argc) requests = std::max(1LL, std::atoll(argv[++i]));
+        else if (a == "--pipeline" && i + 1 < argc) pipeline = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--users" && i + 1 < argc) users = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--cancel") cancel = true;
+        else {
+            std::fprintf(stderr, "未知选项 %s\n", a.c_str());
+            return 1;
+        }
+    }
+
+    std::vector<ClientResult> results((size_t)clients);
+    std::vector<std::thread> pool;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int c = 0; c < clients; ++c) {
+        pool.emplace_back(runClient, path, c, requests, pipeline, users, cancel, std::ref(results[(size_t)c]));
+    }
+    for (auto& t : pool) t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    long long total = 0, errors = 0;
+    std::vector<double> rtt;
+    for (const auto& r : results) {
+        total += r.requests;
+        errors += r.errors;
+        rtt.insert(rtt.end(), r.roundTripUs.begin(), r.roundTripUs.end());
+    }
+    std::sort(rtt.begin(), rtt.end());
+    auto pct = [&rtt](double q) { return rtt.empty() ? 0.0 : rtt[(size_t)(q * (rtt.size() - 1))]; };
+
+    std::printf("clients,pipeline,requests,errors,seconds,req_per_sec,rtt_p50_us,rtt_p99_us\n");
+    std::printf("%d,%d,%lld,%lld,%.3f,%.0f,%.1f,%.1f\n", clients, pipeline, total, errors, seconds,
+                seconds > 0 ? total / seconds : 0.0, pct(0.50), pct(0.99));
+    return errors == 0 ? 0 : 2;
+}
@@ -0,0 +1,174 @@
+#ifndef CSVREADER_H
+#define CSVREADER_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 流式 CSV 读取器：按 1MB 块读文件，逐条记录解析，不把整个文件读入内存。
+// 支持 csvEscape 产生的引号写法（"" 表示一个引号，引号内可含逗号和换行）。
+// next() 返回的 string_view 只在下一次调用 next() 之前有效。
+struct CsvReader {
+    std::FILE* fp = nullptr;
+    std::vector<char> buf;
+    size_t pos = 0, end = 0;
+    bool eof = false;
+
+    explicit CsvReader(const std::string& path, size_t chunk = 1 << 20)
+        : buf(chunk) {
+        fp = std::fopen(path.c_str(), "rb");
+        eof = (fp == nullptr);
+    }
+    CsvReader(const CsvReader&) = delete;
+    CsvReader& operator=(const CsvReader&) = delete;
+    ~CsvReader() { if (fp) std::fclose(fp); }
+
+    bool isOpen() const { return fp != nullptr; }
+
+    // 读取下一条记录；文件结束返回 false
+    bool next(std::vector<std::string_view>& fields) {
+        for (;;) {
+            size_t recEnd = 0;
+            if (parse(recEnd)) {
+                fields.clear();
+                for (const auto& f : spans) {
+                    if (f.scratch) fields.emplace_back(scratch[f.off]);
+                    else fields.emplace_back(buf.data() + f.off, f.len);
+                }
+                pos = recEnd;
+                return true;
+            }
+            if (eof) {
+                pos = end;
+                return false;
+            }
+            refill();
+        }
+    }
+
+    // —— 字段转换工具
+    static int toInt(std::string_view s, int def = 0) {
+        if (s.empty()) return def;
+        bool neg = false;
+        size_t i = 0;
+        if (s[0] == '-') { neg = true; i = 1; }
+        int v = 0;
+        for (; i < s.size(); ++i) {
+            char c = s[i];
+            if (c < '0' || c > '9') return def;
+            v = v * 10 + (c - '0');
+        }
+        return neg ? -v : v;
+    }
+
+    static double toDouble(std::string_view s, double def = 0.0) {
+        if (s.empty()) return def;
+        std::string tmp(s);
+        char* endp = nullptr;
+        double v = std::strtod(tmp.c_str(), &endp);
+        return endp == tmp.c_str() ? def : v;
+    }
+
+private:
+    struct Span {
+        size_t off = 0, len = 0;
+        bool scratch = false;   // 含转义引号的字段存放在 scratch 中
+    };
+    std::vector<Span> spans;
+    std::vector<std::string> scratch;
+
+    void refill() {
+        if (pos > 0) {
+            std::memmove(buf.data(), buf.data() + pos, end - pos);
+            end -= pos;
+            pos = 0;
+        }
+        if (end == buf.size()) buf.resize(buf.size() * 2);   // 单条记录超过缓冲区
+        size_t n = std::fread(buf.data() + end, 1, buf.size() - end, fp);
+        end += n;
+        if (n == 0) eof = true;
+    }
+
+    // 在 [pos, end) 中解析一条完整记录；数据不足（且未到文件尾）返回 false
+    bool parse(size_t& recEnd) {
+        spans.clear();
+        size_t nScratch = 0;
+        size_t i = pos;
+        if (i >= end) return false;
+        for (;;) {
+            Span f;
+            if (i < end && buf[i] == '"') {
+                ++i;
+                size_t start = i;
+                bool escaped = false;
+                for (;;) {
+                    if (i >= end) return false;
+                    if (buf[i] == '"') {
+                        if (i + 1 >= end && !eof) return false;
+                        if (i + 1 < end && buf[i + 1] == '"') { escaped = true; i += 2; continue; }
+                        break;
+                    }
+                    ++i;
+                }
+                if (escaped) {
+                    if (scratch.size() <= nScratch) scratch.emplace_back();
+                    std::string& out = scratch[nScratch];
+                    out.clear();
+                    for (size_t k = start; k < i; ++k) {
+                        out += buf[k];
+                        if (buf[k] == '"') ++k;
+                    }
+                    f.off = nScratch++;
+                    f.scratch = true;
+                } else {
+                    f.off = start;
+                    f.len = i - start;
+                }
+                ++i;   // 跳过结束引号
+            } else {
+                size_t start = i;
+                while (i < end && buf[i] != ',' && buf[i] != '\n' && buf[i] != '\r') ++i;
+                f.off = start;
+                f.len = i - start;
+            }
+            spans.push_back(f);
+
+            if (i >= end) {
+                if (!eof) return false;
+                recEnd = end;
+                return true;
+            }
+            if (buf[i] == ',') { ++i; continue; }
+            // 行尾：兼容 \r\n
+            if (buf[i] == '\r') {
+                if (i + 1 >= end && !eof) return false;
+                ++i;
+                if (i < end && buf[i] == '\n') ++i;
+            } else {
+                ++i;
+            }
+            recEnd = i;
+            return true;
+        }
+    }
+};
+
+// 写 CSV 时的字段转义：含逗号、引号或换行时加引号，引号写成两个
+static inline std::string csvEscape(std::string_view s) {
+    bool need = false;
+    for (char c : s) {
+        if (c == '"' || c == ',' || c == '\n' || c == '\r') { need = true; break; }
+    }
+    if (!need) return std::string(s);
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"') out += "\"\""; else out += c;
+    }
+    out += "\"";
+    return out;
+}
+
+#endif // CSVREADER_H
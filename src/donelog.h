@@ -0,0 +1,657 @@
+#ifndef DONELOG_H
+#define DONELOG_H
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "csvreader.h"
+#include "simtime.h"
+
+// 二进制列式完成日志（只追加，可内存映射）。
+//
+// done.bin 由定长块组成，每块 kBlockRows 行，块内按列存放：
+//   DoneBlockHeader（64 字节）
+//   int32  id[kBlockRows]
+//   int32  pages[kBlockRows]
+//   int32  priority[kBlockRows]
+//   int64  submitTime[kBlockRows]   微秒（SimTime）
+//   int64  startTime[kBlockRows]
+//   int64  finishTime[kBlockRows]
+//   uint64 user[kBlockRows]        done.str 中的偏移
+//   uint64 doc[kBlockRows]         done.str 中的偏移
+//   int32  parent[kBlockRows]      拆分任务的分段：母任务 ID；其它行为 0
+//   int32  firstPage[kBlockRows]   分段的起始页（从 1 开始）；其它行为 0
+//   int64  deadline[kBlockRows]    截止时刻（微秒）；没有截止时刻为 -1
+// 只有最后一块可以不满（header.rows < kBlockRows）。块头记录本块 id、提交时刻、
+// 完成时刻的最小/最大值，按时间范围查询时可以整块跳过。
+// done.str 是字符串堆，每条记录为 uint32 长度 + 字节；同一用户名在一次运行中只写一次。
+// 数值按本机字节序存放。
+// 第 1 版的三个时间列是 int32 整秒，第 2 版没有分段两列，第 3 版没有截止时刻列，
+// upgrade() 把这样的文件就地改写成当前版本。
+
+namespace donelog {
+
+constexpr uint32_t kBlockRows = 4096;
+constexpr char kMagic[4] = {'P', 'M', 'D', 'L'};
+constexpr uint32_t kVersion = 4;
+
+struct DoneBlockHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t rows;
+    uint32_t capacity;
+    int32_t minId, maxId;
+    int64_t minSubmit, maxSubmit;
+    int64_t minFinish, maxFinish;
+    char reserved[8];
+};
+static_assert(sizeof(DoneBlockHeader) == 64, "块头必须是 64 字节");
+
+constexpr size_t kColId = sizeof(DoneBlockHeader);
+constexpr size_t kColPages = kColId + 4 * kBlockRows;
+constexpr size_t kColPriority = kColPages + 4 * kBlockRows;
+constexpr size_t kColSubmit = kColPriority + 4 * kBlockRows;
+constexpr size_t kColStart = kColSubmit + 8 * kBlockRows;
+constexpr size_t kColFinish = kColStart + 8 * kBlockRows;
+constexpr size_t kColUser = kColFinish + 8 * kBlockRows;
+constexpr size_t kColDoc = kColUser + 8 * kBlockRows;
+constexpr size_t kColParent = kColDoc + 8 * kBlockRows;
+constexpr size_t kColFirstPage = kColParent + 4 * kBlockRows;
+constexpr size_t kColDeadline = kColFirstPage + 4 * kBlockRows;
+constexpr size_t kBlockBytes = kColDeadline + 8 * kBlockRows;
+
+// 一块的列视图：指针直接指向映射的文件内容，不复制
+struct BlockView {
+    const DoneBlockHeader* header = nullptr;
+    uint32_t rows = 0;
+    const int32_t* id = nullptr;
+    const int32_t* pages = nullptr;
+    const int32_t* priority = nullptr;
+    const int64_t* submitTime = nullptr;
+    const int64_t* startTime = nullptr;
+    const int64_t* finishTime = nullptr;
+    const uint64_t* user = nullptr;
+    const uint64_t* doc = nullptr;
+    const int32_t* parent = nullptr;
+    const int32_t* firstPage = nullptr;
+    const int64_t* deadline = nullptr;
+
+    static BlockView at(const char* base) {
+        BlockView v;
+        v.header = reinterpret_cast<const DoneBlockHeader*>(base);
+        v.rows = std::min(v.header->rows, kBlockRows);
+        v.id = reinterpret_cast<const int32_t*>(base + kColId);
+        v.pages = reinterpret_cast<const int32_t*>(base + kColPages);
+        v.priority = reinterpret_cast<const int32_t*>(base + kColPriority);
+        v.submitTime = reinterpret_cast<const int64_t*>(base + kColSubmit);
+        v.startTime = reinterpret_cast<const int64_t*>(base + kColStart);
+        v.finishTime = reinterpret_cast<const int64_t*>(base + kColFinish);
+        v.user = reinterpret_cast<const uint64_t*>(base + kColUser);
+        v.doc = reinterpret_cast<const uint64_t*>(base + kColDoc);
+        v.parent = reinterpret_cast<const int32_t*>(base + kColParent);
+        v.firstPage = reinterpret_cast<const int32_t*>(base + kColFirstPage);
+        v.deadline = reinterpret_cast<const int64_t*>(base + kColDeadline);
+        return v;
+    }
+};
+
+// 只读映射的文件
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& o) noexcept { *this = std::move(o); }
+    MappedFile& operator=(MappedFile&& o) noexcept {
+        if (this != &o) {
+            close();
+            ptr = o.ptr;
+            len = o.len;
+#ifdef _WIN32
+            fallback = std::move(o.fallback);   // 移动后缓冲区地址不变
+#endif
+            o.ptr = nullptr;
+            o.len = 0;
+        }
+        return *this;
+    }
+    ~MappedFile() { close(); }
+
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        // 没有 mmap 时整体读入内存
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        fallback.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        ptr = fallback.data();
+        len = fallback.size();
+        return true;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        len = (size_t)st.st_size;
+        if (len > 0) {
+            void* p = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                len = 0;
+                return false;
+            }
+            ptr = static_cast<const char*>(p);
+        }
+        ::close(fd);
+        return true;
+#endif
+    }
+
+    void close() {
+#ifdef _WIN32
+        fallback.clear();
+#else
+        if (ptr && len) munmap(const_cast<char*>(ptr), len);
+#endif
+        ptr = nullptr;
+        len = 0;
+    }
+
+    const char* data() const { return ptr; }
+    size_t size() const { return len; }
+
+private:
+    const char* ptr = nullptr;
+    size_t len = 0;
+#ifdef _WIN32
+    std::vector<char> fallback;
+#endif
+};
+
+// 把旧版 done.bin 改写为当前版本：第 1 版的时间列为 int32 整秒，第 2 版缺少分段两列（补 0），
+// 第 3 版缺少截止时刻列（补 -1）。
+// 逐块转换后写到 .tmp 再改名，done.str 的偏移不变。
+// 文件不存在或已是当前版本时什么也不做；返回 false 表示转换失败
+inline bool upgrade(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return true;
+    char head[sizeof(DoneBlockHeader)];
+    if (!in.read(head, sizeof(head))) return true;
+    uint32_t version;
+    std::memcpy(&version, head + 4, 4);
+    if (std::memcmp(head, kMagic, 4) != 0 || version < 1 || version >= kVersion) return true;
+
+    constexpr size_t kV1Bytes = sizeof(DoneBlockHeader) + 6 * 4 * kBlockRows + 2 * 8 * kBlockRows;
+    constexpr size_t kV2Bytes = kColParent;
+    constexpr size_t kV3Bytes = kColDeadline;
+    in.seekg(0);
+    std::ofstream out(path + ".tmp", std::ios::binary | std::ios::trunc);
+    std::vector<char> src(version == 1 ? kV1Bytes : version == 2 ? kV2Bytes : kV3Bytes), dst(kBlockBytes);
+    while (in.read(src.data(), (std::streamsize)src.size())) {
+        std::fill(dst.begin(), dst.begin() + kColDeadline, 0);
+        std::fill(dst.begin() + kColDeadline, dst.end(), (char)0xFF);   // int64 -1
+        DoneBlockHeader h;
+        std::memcpy(&h, src.data(), 16);   // magic、version、rows、capacity
+        if (std::memcmp(h.magic, kMagic, 4) != 0) break;
+        if (version >= 2) {   // 列的位置不变，只多出后面的列
+            std::memcpy(dst.data(), src.data(), src.size());
+            h.version = kVersion;
+            std::memcpy(dst.data(), &h, 16);
+            out.write(dst.data(), (std::streamsize)dst.size());
+            continue;
+        }
+        int32_t old[6];
+        std::memcpy(old, src.data() + 16, sizeof(old));
+        h.version = kVersion;
+        h.minId = old[0];
+        h.maxId = old[1];
+        h.minSubmit = old[2] * kTicksPerSec;
+        h.maxSubmit = old[3] * kTicksPerSec;
+        h.minFinish = old[4] * kTicksPerSec;
+        h.maxFinish = old[5] * kTicksPerSec;
+        std::memset(h.reserved, 0, sizeof(h.reserved));
+        std::memcpy(dst.data(), &h, sizeof(h));
+        const char* cols = src.data() + sizeof(DoneBlockHeader);
+        std::memcpy(dst.data() + kColId, cols, 3 * 4 * kBlockRows);   // id、pages、priority
+        for (int c = 0; c < 3; ++c) {
+            for (uint32_t r = 0; r < kBlockRows; ++r) {
+                int32_t t;
+                std::memcpy(&t, cols + (3 + c) * 4 * kBlockRows + r * 4, 4);
+                int64_t v = t < 0 ? -1 : (int64_t)t * kTicksPerSec;
+                std::memcpy(dst.data() + kColSubmit + c * 8 * kBlockRows + r * 8, &v, 8);
+            }
+        }
+        std::memcpy(dst.data() + kColUser, cols + 6 * 4 * kBlockRows, 2 * 8 * kBlockRows);
+        out.write(dst.data(), (std::streamsize)dst.size());
+    }
+    in.close();
+    out.close();
+    if (!out) return false;
+#ifdef _WIN32
+    std::remove(path.c_str());
+#endif
+    return std::rename((path + ".tmp").c_str(), path.c_str()) == 0;
+}
+
+} // namespace donelog
+
+// 读取端：映射 done.bin / done.str，按块提供列视图和时间范围查询。
+// 只看到打开时已写入文件的内容。
+class DoneLogReader {
+public:
+    bool open(const std::string& path, const std::string& stringsPath) {
+        close();
+        if (!bin.open(path)) return false;
+        strs.open(stringsPath);
+        nBlocks = bin.size() / donelog::kBlockBytes;
+        nRows = 0;
+        for (size_t b = 0; b < nBlocks; ++b) {
+            donelog::BlockView v = block(b);
+            if (std::memcmp(v.header->magic, donelog::kMagic, 4) != 0 || v.header->version != donelog::kVersion) {
+                nBlocks = b;
+                break;
+            }
+            nRows += v.rows;
+        }
+        return true;
+    }
+
+    void close() {
+        bin.close();
+        strs.close();
+        nBlocks = 0;
+        nRows = 0;
+    }
+
+    uint64_t rows() const { return nRows; }
+    size_t blocks() const { return nBlocks; }
+
+    donelog::BlockView block(size_t i) const {
+        return donelog::BlockView::at(bin.data() + i * donelog::kBlockBytes);
+    }
+
+    std::string_view string(uint64_t off) const {
+        if (off + 4 > strs.size()) return std::string_view();
+        uint32_t n;
+        std::memcpy(&n, strs.data() + off, 4);
+        if (off + 4 + n > strs.size()) return std::string_view();
+        return std::string_view(strs.data() + off + 4, n);
+    }
+
+    // 以下查询只看序号（第几行，从 0 开始）小于 endRow 的行。
+    // 除最后一块外每块都是满的，第 b 块第 r 行的序号为 b * kBlockRows + r。
+
+    // 对每个完成时刻落在 [t1, t2] 内的行调用 fn(const BlockView&, uint32_t row)；
+    // 块头的最小/最大完成时刻不相交的块整块跳过
+    template <typename F>
+    void finishedBetween(SimTime t1, SimTime t2, F&& fn, uint64_t endRow = UINT64_MAX) const {
+        for (size_t b = 0; b < nBlocks; ++b) {
+            donelog::BlockView v = block(b);
+            uint32_t n = rowsBefore(b, v, endRow);
+            if (n == 0) break;
+            if (v.header->maxFinish < t1 || v.header->minFinish > t2) continue;
+            for (uint32_t r = 0; r < n; ++r) {
+                if (v.finishTime[r] >= t1 && v.finishTime[r] <= t2) fn(v, r);
+            }
+        }
+    }
+
+    // 按 ID 查找；块头 ID 范围不含该 ID 的块整块跳过
+    bool findId(int id, donelog::BlockView& view, uint32_t& row, uint64_t endRow = UINT64_MAX) const {
+        for (size_t b = 0; b < nBlocks; ++b) {
+            donelog::BlockView v = block(b);
+            uint32_t n = rowsBefore(b, v, endRow);
+            if (n == 0) break;
+            if (id < v.header->minId || id > v.header->maxId) continue;
+            for (uint32_t r = 0; r < n; ++r) {
+                if (v.id[r] == id) {
+                    view = v;
+                    row = r;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // 对用户名为 name 的行调用 fn(const BlockView&, uint32_t row)。
+    // 只扫描用户列；同一偏移只比较一次字符串
+    template <typename F>
+    void forUser(std::string_view name, F&& fn, uint64_t endRow = UINT64_MAX) const {
+        std::unordered_map<uint64_t, bool> match;
+        for (size_t b = 0; b < nBlocks; ++b) {
+            donelog::BlockView v = block(b);
+            uint32_t n = rowsBefore(b, v, endRow);
+            if (n == 0) break;
+            for (uint32_t r = 0; r < n; ++r) {
+                auto it = match.find(v.user[r]);
+                if (it == match.end()) it = match.emplace(v.user[r], string(v.user[r]) == name).first;
+                if (it->second) fn(v, r);
+            }
+        }
+    }
+
+    // 按需导出为与 data/done.csv 相同格式的文本（时刻写成十进制秒）
+    bool exportCsv(const std::string& out, SimTime t1 = LLONG_MIN, SimTime t2 = LLONG_MAX) const {
+        std::ofstream fout(out, std::ios::trunc);
+        if (!fout) return false;
+        fout << "id,user,doc,pages,submitTime,startTime,finishTime,priority,parent,firstPage,deadline\n";
+        finishedBetween(t1, t2, [&](const donelog::BlockView& v, uint32_t r) {
+            fout << v.id[r] << ","
+                 << csvEscape(string(v.user[r])) << ","
+                 << csvEscape(string(v.doc[r])) << ","
+                 << v.pages[r] << ","
+                 << timeText(v.submitTime[r]) << ","
+                 << timeText(v.startTime[r]) << ","
+                 << timeText(v.finishTime[r]) << ","
+                 << v.priority[r] << ","
+                 << v.parent[r] << ","
+                 << v.firstPage[r] << ","
+                 << timeText(v.deadline[r]) << "\n";
+        });
+        return (bool)fout;
+    }
+
+private:
+    // 第 b 块中序号小于 endRow 的行数
+    static uint32_t rowsBefore(size_t b, const donelog::BlockView& v, uint64_t endRow) {
+        uint64_t start = (uint64_t)b * donelog::kBlockRows;
+        if (endRow <= start) return 0;
+        return (uint32_t)std::min<uint64_t>(v.rows, endRow - start);
+    }
+
+    donelog::MappedFile bin;
+    donelog::MappedFile strs;
+    size_t nBlocks = 0;
+    uint64_t nRows = 0;
+};
+
+// 写入端：在内存里维护最后一块的映像，追加行只改内存；
+// 块写满或 flush() 时把这一块整体写回它在文件中的位置。
+// 字符串先于引用它们的块写出。
+class DoneLogWriter {
+public:
+    std::string path = "data/done.bin";
+    std::string stringsPath = "data/done.str";
+    unsigned long long bytesWritten = 0;   // 累计写出的字节数（块映像 + 字符串）
+
+    DoneLogWriter() = default;
+    DoneLogWriter(const DoneLogWriter&) = delete;
+    DoneLogWriter& operator=(const DoneLogWriter&) = delete;
+    DoneLogWriter(DoneLogWriter&& o) noexcept { *this = std::move(o); }
+    DoneLogWriter& operator=(DoneLogWriter&& o) noexcept {
+        if (this != &o) {
+            close();
+            path = std::move(o.path);
+            stringsPath = std::move(o.stringsPath);
+            bytesWritten = o.bytesWritten;
+            fp = o.fp; o.fp = nullptr;
+            sfp = o.sfp; o.sfp = nullptr;
+            nRows = o.nRows;
+            tail = std::move(o.tail);
+            tailDirty = o.tailDirty;
+            strBytes = o.strBytes;
+            strBuf = std::move(o.strBuf);
+            userOffsets = std::move(o.userOffsets);
+        }
+        return *this;
+    }
+    ~DoneLogWriter() { close(); }
+
+    bool isOpen() const { return fp != nullptr; }
+    uint64_t rows() const { return nRows; }
+
+    // 打开（不存在则创建），接着已有内容继续追加；旧版文件先就地升级
+    bool open() {
+        if (fp) return true;
+        if (!donelog::upgrade(path)) return false;
+        fp = openRw(path);
+        sfp = openRw(stringsPath);
+        if (!fp || !sfp) {
+            close();
+            return false;
+        }
+        strBytes = fileSize(sfp);
+        uint64_t blocks = fileSize(fp) / donelog::kBlockBytes;
+        nRows = 0;
+        tail.assign(donelog::kBlockBytes, 0);
+        if (blocks > 0) {
+            readBlock(blocks - 1);
+            uint32_t last = header().rows;
+            if (std::memcmp(header().magic, donelog::kMagic, 4) != 0) last = 0;
+            nRows = (blocks - 1) * donelog::kBlockRows + last;
+        }
+        if (nRows % donelog::kBlockRows == 0) startBlock();
+        return true;
+    }
+
+    void close() {
+        if (fp) flush(false);
+        if (fp) std::fclose(fp);
+        if (sfp) std::fclose(sfp);
+        fp = sfp = nullptr;
+        userOffsets.clear();
+    }
+
+    // 恢复时丢弃快照之后才写入的行（它们会由日志重放重新追加）
+    void truncate(uint64_t n) {
+        if (!fp && !open()) return;
+        flush(false);
+        if (n >= nRows) return;
+        nRows = n;
+        uint64_t blocks = (n + donelog::kBlockRows - 1) / donelog::kBlockRows;
+        resizeFile(path, blocks * donelog::kBlockBytes);
+        tail.assign(donelog::kBlockBytes, 0);
+        if (n % donelog::kBlockRows == 0) {
+            startBlock();
+            return;
+        }
+        readBlock(blocks - 1);
+        header().rows = (uint32_t)(n % donelog::kBlockRows);
+        recomputeBounds();
+        tailDirty = true;
+    }
+
+    // Job 需提供 id、pages、priority、submitTime、startTime、finishTime、parent、firstPage、deadline、
+    // user、userName()、docName()
+    template <typename Job>
+    void append(const Job& j) {
+        if (!fp && !open()) return;
+        uint32_t r = (uint32_t)(nRows % donelog::kBlockRows);
+        put<int32_t>(donelog::kColId, r, j.id);
+        put<int32_t>(donelog::kColPages, r, j.pages);
+        put<int32_t>(donelog::kColPriority, r, j.priority);
+        put<int64_t>(donelog::kColSubmit, r, j.submitTime);
+        put<int64_t>(donelog::kColStart, r, j.startTime);
+        put<int64_t>(donelog::kColFinish, r, j.finishTime);
+        put<uint64_t>(donelog::kColUser, r, userOffset(j.user, j.userName()));
+        put<uint64_t>(donelog::kColDoc, r, addString(j.docName()));
+        put<int32_t>(donelog::kColParent, r, j.parent);
+        put<int32_t>(donelog::kColFirstPage, r, j.firstPage);
+        put<int64_t>(donelog::kColDeadline, r, j.deadline);
+        donelog::DoneBlockHeader& h = header();
+        if (r == 0) {
+            h.minId = h.maxId = j.id;
+            h.minSubmit = h.maxSubmit = j.submitTime;
+            h.minFinish = h.maxFinish = j.finishTime;
+        } else {
+            h.minId = std::min(h.minId, j.id);
+            h.maxId = std::max(h.maxId, j.id);
+            h.minSubmit = std::min<int64_t>(h.minSubmit, j.submitTime);
+            h.maxSubmit = std::max<int64_t>(h.maxSubmit, j.submitTime);
+            h.minFinish = std::min<int64_t>(h.minFinish, j.finishTime);
+            h.maxFinish = std::max<int64_t>(h.maxFinish, j.finishTime);
+        }
+        h.rows = r + 1;
+        ++nRows;
+        tailDirty = true;
+        if (h.rows == donelog::kBlockRows) {
+            writeTail();
+            startBlock();
+        }
+    }
+
+    // 写出缓冲的字符串和最后一块；sync 为真时再 fsync
+    void flush(bool sync) {
+        if (!fp) return;
+        writeStrings();
+        if (tailDirty && header().rows > 0) writeTail();
+        std::fflush(fp);
+        if (sync) {
+#ifdef _WIN32
+            _commit(_fileno(sfp));
+            _commit(_fileno(fp));
+#else
+            fsync(fileno(sfp));
+            fsync(fileno(fp));
+#endif
+        }
+    }
+
+private:
+    static std::FILE* openRw(const std::string& p) {
+        std::FILE* f = std::fopen(p.c_str(), "r+b");
+        if (!f) f = std::fopen(p.c_str(), "w+b");
+        return f;
+    }
+
+    static void seek(std::FILE* f, uint64_t off) {
+#ifdef _WIN32
+        _fseeki64(f, (long long)off, SEEK_SET);
+#else
+        fseeko(f, (off_t)off, SEEK_SET);
+#endif
+    }
+
+    static uint64_t fileSize(std::FILE* f) {
+#ifdef _WIN32
+        _fseeki64(f, 0, SEEK_END);
+        return (uint64_t)_ftelli64(f);
+#else
+        fseeko(f, 0, SEEK_END);
+        return (uint64_t)ftello(f);
+#endif
+    }
+
+    static void resizeFile(const std::string& p, uint64_t size) {
+#ifdef _WIN32
+        std::FILE* f = std::fopen(p.c_str(), "r+b");
+        if (!f) return;
+        _chsize_s(_fileno(f), (long long)size);
+        std::fclose(f);
+#else
+        if (::truncate(p.c_str(), (off_t)size) != 0) return;
+#endif
+    }
+
+    donelog::DoneBlockHeader& header() {
+        return *reinterpret_cast<donelog::DoneBlockHeader*>(tail.data());
+    }
+
+    template <typename T>
+    void put(size_t col, uint32_t row, T v) {
+        std::memcpy(tail.data() + col + row * sizeof(T), &v, sizeof(T));
+    }
+    template <typename T>
+    T get(size_t col, uint32_t row) const {
+        T v;
+        std::memcpy(&v, tail.data() + col + row * sizeof(T), sizeof(T));
+        return v;
+    }
+
+    void startBlock() {
+        std::fill(tail.begin(), tail.end(), 0);
+        donelog::DoneBlockHeader& h = header();
+        std::memcpy(h.magic, donelog::kMagic, 4);
+        h.version = donelog::kVersion;
+        h.capacity = donelog::kBlockRows;
+        tailDirty = false;
+    }
+
+    void readBlock(uint64_t b) {
+        seek(fp, b * donelog::kBlockBytes);
+        if (std::fread(tail.data(), 1, tail.size(), fp) != tail.size()) startBlock();
+        tailDirty = false;
+    }
+
+    void recomputeBounds() {
+        donelog::DoneBlockHeader& h = header();
+        for (uint32_t r = 0; r < h.rows; ++r) {
+            int32_t id = get<int32_t>(donelog::kColId, r);
+            int64_t s = get<int64_t>(donelog::kColSubmit, r);
+            int64_t f = get<int64_t>(donelog::kColFinish, r);
+            h.minId = r ? std::min(h.minId, id) : id;
+            h.maxId = r ? std::max(h.maxId, id) : id;
+            h.minSubmit = r ? std::min(h.minSubmit, s) : s;
+            h.maxSubmit = r ? std::max(h.maxSubmit, s) : s;
+            h.minFinish = r ? std::min(h.minFinish, f) : f;
+            h.maxFinish = r ? std::max(h.maxFinish, f) : f;
+        }
+    }
+
+    void writeTail() {
+        writeStrings();
+        uint64_t b = (nRows - 1) / donelog::kBlockRows;
+        seek(fp, b * donelog::kBlockBytes);
+        std::fwrite(tail.data(), 1, tail.size(), fp);
+        bytesWritten += tail.size();
+        tailDirty = false;
+    }
+
+    uint64_t addString(std::string_view s) {
+        uint64_t off = strBytes + strBuf.size();
+        uint32_t n = (uint32_t)s.size();
+        strBuf.append(reinterpret_cast<const char*>(&n), 4);
+        strBuf.append(s.data(), s.size());
+        if (strBuf.size() >= (1 << 16)) writeStrings();
+        return off;
+    }
+
+    uint64_t userOffset(uint32_t id, std::string_view name) {
+        auto it = userOffsets.find(id);
+        if (it != userOffsets.end()) return it->second;
+        uint64_t off = addString(name);
+        userOffsets.emplace(id, off);
+        return off;
+    }
+
+    void writeStrings() {
+        if (strBuf.empty()) return;
+        fileSize(sfp);   // 定位到末尾
+        std::fwrite(strBuf.data(), 1, strBuf.size(), sfp);
+        std::fflush(sfp);
+        strBytes += strBuf.size();
+        bytesWritten += strBuf.size();
+        strBuf.clear();
+    }
+
+    std::FILE* fp = nullptr;
+    std::FILE* sfp = nullptr;
+    uint64_t nRows = 0;
+    std::vector<char> tail;                       // 最后一块的映像
+    bool tailDirty = false;
+    uint64_t strBytes = 0;                        // done.str 已写出的字节数
+    std::string strBuf;                           // 尚未写出的字符串
+    std::unordered_map<uint32_t, uint64_t> userOffsets;   // 用户名编号 → done.str 偏移
+};
+
+#endif // DONELOG_H
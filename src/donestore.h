@@ -0,0 +1,148 @@
+#ifndef DONESTORE_H
+#define DONESTORE_H
+
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <climits>
+#include <cstdint>
+#include <cstddef>
+
+// 完成记录的热数据窗口：只在内存里保留最近 maxJobs 条、或完成时刻在最近 maxAge 内的记录，
+// 更早的记录被逐出（持久化开启时它们已在 done.bin 中，查询时从文件读取）。
+//
+// 每条记录有一个全局序号（第几个完成的任务，从 0 开始）；窗口覆盖序号 [first(), total())。
+// 记录存放在环形缓冲区中，追加和逐出都是 O(1)；另外维护
+//   - id → 序号 的哈希索引（按 ID 查找 O(1)）；
+//   - 用户 → 序号列表（按用户查找只访问该用户的记录，逐出时从列表头部弹出）。
+// 记录按完成顺序追加，完成时刻单调不减，按时间区间查找用二分。
+// Job 需提供 id、user（可哈希）和 finishTime 字段；时长与 finishTime 同单位。
+template <typename Job>
+class DoneRing {
+public:
+    using User = decltype(Job::user);
+
+    size_t maxJobs = 0;   // 最多保留的条数，0 表示不限
+    long long maxAge = 0; // 最多保留的时长（相对最新的完成时刻或当前时钟），0 表示不限
+
+    explicit DoneRing(size_t max_jobs = 0, long long max_age = 0)
+        : maxJobs(max_jobs), maxAge(max_age) {}
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    uint64_t first() const { return base; }           // 窗口内最早一条的序号
+    uint64_t total() const { return base + count; }   // 累计完成条数
+
+    // 窗口内第 i 条（0 为最早）
+    const Job& operator[](size_t i) const { return buf[(head + i) & (buf.size() - 1)]; }
+    const Job& back() const { return (*this)[count - 1]; }
+
+    // 按完成顺序遍历窗口内的记录
+    class const_iterator {
+    public:
+        const_iterator(const DoneRing* r, size_t i) : ring(r), pos(i) {}
+        const Job& operator*() const { return (*ring)[pos]; }
+        const Job* operator->() const { return &(*ring)[pos]; }
+        const_iterator& operator++() { ++pos; return *this; }
+        bool operator==(const const_iterator& o) const { return pos == o.pos; }
+        bool operator!=(const const_iterator& o) const { return pos != o.pos; }
+    private:
+        const DoneRing* ring;
+        size_t pos;
+    };
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, count); }
+
+    // 按全局序号取记录；不在窗口内时返回 nullptr
+    const Job* at(uint64_t seq) const {
+        if (seq < base || seq >= total()) return nullptr;
+        return &(*this)[(size_t)(seq - base)];
+    }
+
+    void clear() {
+        buf.clear();
+        head = count = 0;
+        base = 0;
+        byId.clear();
+        byUser.clear();
+    }
+
+    // 跳过 n 条不进入内存的记录（恢复时已超出保留范围的部分）；只能在窗口为空时调用
+    void skip(uint64_t n = 1) {
+        if (count == 0) base += n;
+    }
+
+    void push(const Job& j) {
+        if (count == buf.size()) grow();
+        uint64_t seq = total();
+        buf[(head + count) & (buf.size() - 1)] = j;
+        ++count;
+        byId[j.id] = seq;
+        byUser[j.user].push_back(seq);
+        trim(j.finishTime);
+    }
+
+    // 按保留策略逐出最早的记录；now 为当前时钟
+    void trim(long long now) {
+        while (maxJobs > 0 && count > maxJobs) popFront();
+        if (maxAge > 0) {
+            while (count > 0 && (*this)[0].finishTime < now - maxAge) popFront();
+        }
+    }
+
+    const Job* findId(int id) const {
+        auto it = byId.find(id);
+        return it == byId.end() ? nullptr : at(it->second);
+    }
+
+    // 按完成顺序对该用户窗口内的记录调用 fn(const Job&)
+    template <typename F>
+    void forUser(User user, F&& fn) const {
+        auto it = byUser.find(user);
+        if (it == byUser.end()) return;
+        for (uint64_t seq : it->second) fn(*at(seq));
+    }
+
+    // 按完成顺序对完成时刻在 [t1, t2] 内的记录调用 fn(const Job&)
+    template <typename F>
+    void finishedBetween(long long t1, long long t2, F&& fn) const {
+        size_t lo = 0, hi = count;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if ((*this)[mid].finishTime < t1) lo = mid + 1;
+            else hi = mid;
+        }
+        for (size_t i = lo; i < count && (*this)[i].finishTime <= t2; ++i) fn((*this)[i]);
+    }
+
+private:
+    void popFront() {
+        const Job& j = buf[head];
+        byId.erase(j.id);
+        auto it = byUser.find(j.user);
+        if (it != byUser.end()) {
+            it->second.pop_front();   // 该用户最早的一条就是它
+            if (it->second.empty()) byUser.erase(it);
+        }
+        head = (head + 1) & (buf.size() - 1);
+        --count;
+        ++base;
+    }
+
+    // 容量保持为 2 的幂，下标用位与取模
+    void grow() {
+        std::vector<Job> next(buf.empty() ? 64 : buf.size() * 2);
+        for (size_t i = 0; i < count; ++i) next[i] = (*this)[i];
+        buf.swap(next);
+        head = 0;
+    }
+
+    std::vector<Job> buf;   // 环形缓冲区
+    size_t head = 0;
+    size_t count = 0;
+    uint64_t base = 0;      // buf[head] 的全局序号
+    std::unordered_map<int, uint64_t> byId;
+    std::unordered_map<User, std::deque<uint64_t>> byUser;
+};
+
+#endif // DONESTORE_H
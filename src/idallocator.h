@@ -0,0 +1,35 @@
+#ifndef IDALLOCATOR_H
+#define IDALLOCATOR_H
+
+#include <atomic>
+
+// 多个 PrintManager（分片）共享的任务 ID 空间。
+// 各分片每次领取 kBlock 个连续 ID，块内分配只动分片自己的字段（见 PrintManager::takeIds），
+// 因此共享的原子计数器大约每 kBlock 个任务才被访问一次，不会成为多核提交的瓶颈。
+// ID 全局唯一，但不同分片的 ID 不按提交先后排序；崩溃时未用完的块留下空号。
+class IdAllocator {
+public:
+    static constexpr int kBlock = 1024;
+
+    // 领取 [返回值, 返回值 + n)
+    int reserve(int n) {
+        return next.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    // 恢复后调用：以后分配的 ID 都不小于 id
+    void raiseTo(int id) {
+        int cur = next.load(std::memory_order_relaxed);
+        while (cur < id && !next.compare_exchange_weak(cur, id, std::memory_order_relaxed)) {
+        }
+    }
+
+    // 下一个未领取的 ID
+    int peek() const {
+        return next.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<int> next{1};
+};
+
+#endif // IDALLOCATOR_H
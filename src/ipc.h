@@ -0,0 +1,786 @@
+#ifndef IPC_H
+#define IPC_H
+
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "printmanager.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+// 本机进程间提交接口：Unix 域套接字上的长度前缀二进制协议。
+//
+// 帧：u32 负载长度（不含这 4 字节） + 负载；整数一律小端，f64 为 IEEE 754 小端。
+//   请求负载：u8 op, u32 tag, 参数
+//     Submit  u16 用户名长度, 用户名, u16 文档名长度, 文档名, i32 pages, i32 priority[, i64 deadline]
+//             deadline 为提交后多少微秒内须完成，省略或为 0 表示没有截止时刻；
+//             负数或加上当前时刻后超出 i64 时 status = BadRequest
+//     Cancel  i32 id
+//     Status  i32 id
+//     Stats   （无）
+//   响应负载：u8 (op | 0x80), u32 tag（原样返回）, u8 status, 结果
+//     Submit  i32 id（被准入控制拒绝时 status = Rejected）
+//     Cancel  （无；找不到时 status = NotFound）
+//     Status  u8 state（PrintManager::JobState，4 为已暂停）, i64 submitTime, i64 startTime, i64 finishTime（微秒）
+//     Stats   i64 currentTime（微秒）, u32 waiting, u32 busy, u32 printers, u64 completed,
+//             f64 avgWait, f64 p95Wait, f64 utilisation
+// 同一连接上的响应与请求顺序一致，客户端可以连续发送多条请求（流水线）而不必等待。
+//
+// 服务端（IpcServer，仅 Linux，基于 epoll）在自己的 I/O 线程上读写，一次读到的全部完整帧
+// 打包成一条命令交给引擎线程（SimWorker::post），其中的添加、取消只同步一次日志；
+// 引擎线程把响应交回 I/O 线程发送，界面线程和引擎都不会因为客户端而阻塞。
+
+namespace ipc {
+
+enum class Op : uint8_t { Submit = 1, Cancel = 2, Status = 3, Stats = 4 };
+enum class Status : uint8_t { Ok = 0, NotFound = 1, BadRequest = 2, Rejected = 3 };
+
+// 最长的合法帧：Submit 带两个满长（65535 字节）的字符串和截止时刻。
+// 超过此长度的帧不可能是合法请求，视为协议错误，断开连接
+constexpr uint32_t kMaxFrame = 1 + 4 + 2 * (2 + 0xFFFF) + 4 + 4 + 8;
+constexpr uint8_t kReplyBit = 0x80;
+
+struct Request {
+    Op op = Op::Stats;
+    uint32_t tag = 0;
+    bool valid = true;           // 帧长度合法但内容无法解析时为 false，响应 BadRequest
+    std::string user;
+    std::string doc;
+    int32_t pages = 0;
+    int32_t priority = 0;
+    int64_t deadline = 0;        // 相对提交时刻（微秒），0 为没有
+    int32_t id = 0;
+};
+
+struct Response {
+    Op op = Op::Stats;
+    uint32_t tag = 0;
+    Status status = Status::Ok;
+    int32_t id = 0;              // Submit
+    uint8_t state = 0;           // Status
+    int64_t submitTime = -1, startTime = -1, finishTime = -1;
+    int64_t currentTime = 0;     // Stats
+    uint32_t waiting = 0, busy = 0, printers = 0;
+    uint64_t completed = 0;
+    double avgWait = 0.0, p95Wait = 0.0, utilisation = 0.0;
+};
+
+// —— 编码：先占 4 字节长度，写完负载后回填
+class Writer {
+public:
+    explicit Writer(std::string& buf) : out(buf), start(buf.size()) { out.append(4, '\0'); }
+
+    void u8(uint8_t v) { out.push_back((char)v); }
+    void u16(uint16_t v) { put(v, 2); }
+    void u32(uint32_t v) { put(v, 4); }
+    void u64(uint64_t v) { put(v, 8); }
+    void i32(int32_t v) { put((uint32_t)v, 4); }
+    void i64(int64_t v) { put((uint64_t)v, 8); }
+    void f64(double v) {
+        uint64_t b;
+        std::memcpy(&b, &v, 8);
+        put(b, 8);
+    }
+    void str(std::string_view s) {   // u16 长度 + 字节，超长部分截断
+        size_t n = std::min<size_t>(s.size(), 0xFFFF);
+        u16((uint16_t)n);
+        out.append(s.data(), n);
+    }
+
+    void finish() {
+        uint32_t len = (uint32_t)(out.size() - start - 4);
+        for (int i = 0; i < 4; ++i) out[start + i] = (char)((len >> (8 * i)) & 0xFF);
+    }
+
+private:
+    void put(uint64_t v, int bytes) {
+        for (int i = 0; i < bytes; ++i) out.push_back((char)((v >> (8 * i)) & 0xFF));
+    }
+
+    std::string& out;
+    size_t start;
+};
+
+// —— 解码：越界时 ok 置为 false，之后的读取都返回 0
+class Reader {
+public:
+    Reader(const char* data, size_t size) : p((const unsigned char*)data), n(size) {}
+
+    bool ok = true;
+
+    uint8_t u8() { return (uint8_t)get(1); }
+    uint16_t u16() { return (uint16_t)get(2); }
+    uint32_t u32() { return (uint32_t)get(4); }
+    uint64_t u64() { return get(8); }
+    int32_t i32() { return (int32_t)(uint32_t)get(4); }
+    int64_t i64() { return (int64_t)get(8); }
+    double f64() {
+        uint64_t b = get(8);
+        double v;
+        std::memcpy(&v, &b, 8);
+        return v;
+    }
+    std::string str() {
+        size_t len = u16();
+        if (!ok || pos + len > n) {
+            ok = false;
+            return std::string();
+        }
+        std::string s((const char*)p + pos, len);
+        pos += len;
+        return s;
+    }
+    bool atEnd() const { return pos == n; }
+
+private:
+    uint64_t get(int bytes) {
+        if (!ok || pos + (size_t)bytes > n) {
+            ok = false;
+            return 0;
+        }
+        uint64_t v = 0;
+        for (int i = 0; i < bytes; ++i) v |= (uint64_t)p[pos + i] << (8 * i);
+        pos += (size_t)bytes;
+        return v;
+    }
+
+    const unsigned char* p;
+    size_t n;
+    size_t pos = 0;
+};
+
+inline void encode(std::string& out, const Request& r) {
+    Writer w(out);
+    w.u8((uint8_t)r.op);
+    w.u32(r.tag);
+    switch (r.op) {
+    case Op::Submit:
+        w.str(r.user);
+        w.str(r.doc);
+        w.i32(r.pages);
+        w.i32(r.priority);
+        if (r.deadline != 0) w.i64(r.deadline);
+        break;
+    case Op::Cancel:
+    case Op::Status:
+        w.i32(r.id);
+        break;
+    case Op::Stats:
+        break;
+    }
+    w.finish();
+}
+
+inline bool decode(const char* data, size_t size, Request& r) {
+    Reader in(data, size);
+    uint8_t op = in.u8();
+    r.tag = in.u32();
+    r.op = (Op)op;
+    switch (r.op) {
+    case Op::Submit:
+        r.user = in.str();
+        r.doc = in.str();
+        r.pages = in.i32();
+        r.priority = in.i32();
+        r.deadline = in.ok && !in.atEnd() ? in.i64() : 0;
+        break;
+    case Op::Cancel:
+    case Op::Status:
+        r.id = in.i32();
+        break;
+    case Op::Stats:
+        break;
+    default:
+        return false;
+    }
+    return in.ok && in.atEnd();
+}
+
+inline void encode(std::string& out, const Response& r) {
+    Writer w(out);
+    w.u8((uint8_t)r.op | kReplyBit);
+    w.u32(r.tag);
+    w.u8((uint8_t)r.status);
+    if (r.status == Status::Ok) {
+        switch (r.op) {
+        case Op::Submit:
+            w.i32(r.id);
+            break;
+        case Op::Cancel:
+            break;
+        case Op::Status:
+            w.u8(r.state);
+            w.i64(r.submitTime);
+            w.i64(r.startTime);
+            w.i64(r.finishTime);
+            break;
+        case Op::Stats:
+            w.i64(r.currentTime);
+            w.u32(r.waiting);
+            w.u32(r.busy);
+            w.u32(r.printers);
+            w.u64(r.completed);
+            w.f64(r.avgWait);
+            w.f64(r.p95Wait);
+            w.f64(r.utilisation);
+            break;
+        }
+    }
+    w.finish();
+}
+
+inline bool decode(const char* data, size_t size, Response& r) {
+    Reader in(data, size);
+    uint8_t op = in.u8();
+    if (!(op & kReplyBit)) return false;
+    r.op = (Op)(op & ~kReplyBit);
+    r.tag = in.u32();
+    r.status = (Status)in.u8();
+    if (in.ok && r.status == Status::Ok) {
+        switch (r.op) {
+        case Op::Submit:
+            r.id = in.i32();
+            break;
+        case Op::Cancel:
+            break;
+        case Op::Status:
+            r.state = in.u8();
+            r.submitTime = in.i64();
+            r.startTime = in.i64();
+            r.finishTime = in.i64();
+            break;
+        case Op::Stats:
+            r.currentTime = in.i64();
+            r.waiting = in.u32();
+            r.busy = in.u32();
+            r.printers = in.u32();
+            r.completed = in.u64();
+            r.avgWait = in.f64();
+            r.p95Wait = in.f64();
+            r.utilisation = in.f64();
+            break;
+        default:
+            return false;
+        }
+    }
+    return in.ok && in.atEnd();
+}
+
+// 缓冲区 [off, size) 开头是否有一个完整的帧：有则返回负载位置和长度并返回 1，
+// 不完整返回 0，长度超过 kMaxFrame 返回 -1
+inline int nextFrame(const std::string& buf, size_t off, const char** payload, uint32_t* len) {
+    if (buf.size() - off < 4) return 0;
+    const unsigned char* p = (const unsigned char*)buf.data() + off;
+    uint32_t n = (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+    if (n > kMaxFrame) return -1;
+    if (buf.size() - off - 4 < n) return 0;
+    *payload = buf.data() + off + 4;
+    *len = n;
+    return 1;
+}
+
+// 在引擎线程上执行一批请求，响应依次追加到 out。添加、取消的日志只同步一次
+inline void execute(PrintManager& pm, const std::vector<Request>& reqs, std::string& out) {
+    pm.beginBatch();
+    for (const Request& q : reqs) {
+        Response r;
+        r.op = q.op;
+        r.tag = q.tag;
+        if (!q.valid) {
+            r.status = Status::BadRequest;
+            encode(out, r);
+            continue;
+        }
+        switch (q.op) {
+        case Op::Submit:
+            // deadline 来自客户端：加上当前时刻会溢出的视为非法，而不是回绕成负数（没有截止时刻）
+            if (q.pages <= 0 || q.deadline < 0 || q.deadline > LLONG_MAX - pm.currentTime) r.status = Status::BadRequest;
+            else if (!(r.id = pm.addJob(q.user, q.doc, q.pages, q.priority,
+                                        q.deadline > 0 ? pm.currentTime + q.deadline : -1)))
+                r.status = Status::Rejected;
+            break;
+        case Op::Cancel:
+            if (!pm.cancelJob(q.id)) r.status = Status::NotFound;
+            break;
+        case Op::Status: {
+            PrintJob j;
+            PrintManager::JobState st = pm.findJob(q.id, &j);
+            if (st == PrintManager::JobState::Unknown) {
+                r.status = Status::NotFound;
+            } else {
+                r.state = (uint8_t)st;
+                r.submitTime = j.submitTime;
+                r.startTime = j.startTime;
+                r.finishTime = j.finishTime;
+            }
+            break;
+        }
+        case Op::Stats: {
+            PrintManager::Statistics st = pm.getStatistics();
+            r.currentTime = pm.currentTime;
+            r.waiting = (uint32_t)pm.waitQ.size();
+            r.busy = (uint32_t)pm.busyCount();
+            r.printers = (uint32_t)pm.printers.size();
+            r.completed = (uint64_t)st.totalCompleted;
+            r.avgWait = st.avgWaitTime;
+            r.p95Wait = st.p95Wait;
+            r.utilisation = st.utilisation;
+            break;
+        }
+        }
+        encode(out, r);
+    }
+    pm.endBatch();
+}
+
+} // namespace ipc
+
+// 服务端：一个 I/O 线程处理全部连接（非阻塞套接字 + epoll，水平触发）。
+// post 把命令交给引擎线程（例如 SimWorker::post），命令按投递顺序执行。
+// 每个连接最多有 maxInflight 批请求在引擎队列中，待发送的响应超过 maxPendingOut 字节时
+// 暂停读取该连接，慢客户端不会让服务端无限制地占用内存。
+class IpcServer {
+public:
+    using Command = std::function<void(PrintManager&)>;
+    using Post = std::function<void(Command)>;
+
+    int maxInflight = 64;
+    size_t maxPendingOut = 8u << 20;
+
+    IpcServer() = default;
+    IpcServer(const IpcServer&) = delete;
+    IpcServer& operator=(const IpcServer&) = delete;
+    ~IpcServer() { stop(); }
+
+    // 监听 socketPath（已存在的同名文件先删除）；非 Linux 平台返回 false
+    bool start(const std::string& socketPath, Post postFn) {
+#ifdef __linux__
+        stop();
+        sockaddr_un addr{};
+        if (socketPath.size() >= sizeof(addr.sun_path)) return false;
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+        ::unlink(socketPath.c_str());
+        lfd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (lfd < 0) return false;
+        if (::bind(lfd, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(lfd, 128) != 0) {
+            ::close(lfd);
+            lfd = -1;
+            return false;
+        }
+        ep = ::epoll_create1(EPOLL_CLOEXEC);
+        outbox = std::make_shared<Outbox>();
+        outbox->efd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (ep < 0 || outbox->efd < 0) {
+            stop();
+            return false;
+        }
+        watch(lfd, kListenKey, EPOLLIN);
+        watch(outbox->efd, kWakeKey, EPOLLIN);
+        path = socketPath;
+        post = std::move(postFn);
+        quit = false;
+        th = std::thread([this]() { loop(); });
+        return true;
+#else
+        (void)socketPath;
+        (void)postFn;
+        return false;
+#endif
+    }
+
+    // 关闭全部连接；引擎队列中尚未执行的批次执行后响应被丢弃
+    void stop() {
+#ifdef __linux__
+        if (th.joinable()) {
+            quit = true;
+            outbox->wake();
+            th.join();
+        }
+        for (auto& kv : conns) ::close(kv.second.fd);
+        conns.clear();
+        if (outbox) {
+            std::lock_guard<std::mutex> lock(outbox->mutex);
+            if (outbox->efd >= 0) ::close(outbox->efd);
+            outbox->efd = -1;
+            outbox->replies.clear();
+        }
+        outbox.reset();
+        if (ep >= 0) ::close(ep);
+        ep = -1;
+        if (lfd >= 0) {
+            ::close(lfd);
+            ::unlink(path.c_str());
+        }
+        lfd = -1;
+#endif
+    }
+
+    unsigned long long requests() const { return handled.load(std::memory_order_relaxed); }
+    size_t connections() const { return connCount.load(std::memory_order_relaxed); }
+
+private:
+#ifdef __linux__
+    static constexpr uint64_t kListenKey = 0;
+    static constexpr uint64_t kWakeKey = 1;
+
+    // 引擎线程交回的响应。命令可能在服务端停止之后才执行，因此单独用 shared_ptr 持有
+    struct Outbox {
+        std::mutex mutex;
+        int efd = -1;
+        std::vector<std::pair<uint64_t, std::string>> replies;   // 连接编号 → 响应字节
+
+        void push(uint64_t conn, std::string bytes) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (efd < 0) return;
+            replies.emplace_back(conn, std::move(bytes));
+            if (replies.size() == 1) wakeLocked();
+        }
+        void wake() {
+            std::lock_guard<std::mutex> lock(mutex);
+            wakeLocked();
+        }
+        void wakeLocked() {
+            uint64_t one = 1;
+            if (efd >= 0) (void)!::write(efd, &one, sizeof(one));
+        }
+    };
+
+    struct Conn {
+        int fd = -1;
+        std::string in;
+        std::string out;
+        size_t outOff = 0;
+        int inflight = 0;
+        bool eof = false;
+        bool registered = false;   // 是否在 epoll 中（没有关注的事件时移出，避免挂断事件反复唤醒）
+        uint32_t events = 0;
+    };
+
+    void watch(int fd, uint64_t key, uint32_t events) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.u64 = key;
+        ::epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    void loop() {
+        epoll_event evs[64];
+        while (!quit) {
+            int n = ::epoll_wait(ep, evs, 64, 500);
+            for (int i = 0; i < n && !quit; ++i) {
+                uint64_t key = evs[i].data.u64;
+                if (key == kListenKey) {
+                    acceptAll();
+                } else if (key == kWakeKey) {
+                    uint64_t v;
+                    (void)!::read(outbox->efd, &v, sizeof(v));
+                    drainReplies();
+                } else {
+                    auto it = conns.find(key);
+                    if (it == conns.end()) continue;
+                    if (evs[i].events & EPOLLOUT) flush(it->second);
+                    if (evs[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) readAll(key, it->second);
+                    settle(key);
+                }
+            }
+        }
+    }
+
+    void acceptAll() {
+        for (;;) {
+            int fd = ::accept4(lfd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;
+            uint64_t key = nextKey++;
+            Conn& c = conns[key];
+            c.fd = fd;
+            c.events = EPOLLIN;
+            c.registered = true;
+            watch(fd, key, c.events);
+            connCount.store(conns.size(), std::memory_order_relaxed);
+        }
+    }
+
+    // 读到 EAGAIN 为止（每次最多 1MB，避免一个连接独占 I/O 线程），切出完整的帧，整批交给引擎
+    void readAll(uint64_t key, Conn& c) {
+        char buf[64 * 1024];
+        size_t got = 0;
+        while (got < (1u << 20)) {
+            ssize_t n = ::read(c.fd, buf, sizeof(buf));
+            if (n > 0) {
+                c.in.append(buf, (size_t)n);
+                got += (size_t)n;
+                continue;
+            }
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) c.eof = true;
+            if (n < 0 && errno == EINTR) continue;
+            break;
+        }
+
+        std::vector<ipc::Request> reqs;
+        size_t off = 0;
+        const char* payload;
+        uint32_t len;
+        for (int r; (r = ipc::nextFrame(c.in, off, &payload, &len)) != 0;) {
+            if (r < 0) {   // 长度非法，之后的字节流无法再对齐
+                c.eof = true;
+                c.in.clear();
+                off = 0;
+                break;
+            }
+            ipc::Request q;
+            q.valid = ipc::decode(payload, len, q);
+            reqs.push_back(std::move(q));
+            off += 4 + (size_t)len;
+        }
+        c.in.erase(0, off);
+        if (reqs.empty()) return;
+
+        c.inflight++;
+        handled.fetch_add(reqs.size(), std::memory_order_relaxed);
+        std::shared_ptr<Outbox> box = outbox;
+        post([box, key, reqs = std::move(reqs)](PrintManager& pm) {
+            std::string out;
+            ipc::execute(pm, reqs, out);
+            box->push(key, std::move(out));
+        });
+    }
+
+    void drainReplies() {
+        std::vector<std::pair<uint64_t, std::string>> batch;
+        {
+            std::lock_guard<std::mutex> lock(outbox->mutex);
+            batch.swap(outbox->replies);
+        }
+        for (auto& r : batch) {
+            auto it = conns.find(r.first);
+            if (it == conns.end()) continue;   // 连接已关闭
+            Conn& c = it->second;
+            c.inflight--;
+            c.out += r.second;
+        }
+        for (auto& r : batch) {
+            auto it = conns.find(r.first);
+            if (it == conns.end()) continue;
+            flush(it->second);
+            settle(r.first);
+        }
+    }
+
+    void flush(Conn& c) {
+        while (c.outOff < c.out.size()) {
+            ssize_t n = ::send(c.fd, c.out.data() + c.outOff, c.out.size() - c.outOff, MSG_NOSIGNAL);
+            if (n > 0) {
+                c.outOff += (size_t)n;
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            c.eof = true;   // 对端已关闭
+            c.out.clear();
+            c.outOff = 0;
+            return;
+        }
+        if (c.outOff == c.out.size()) {
+            c.out.clear();
+            c.outOff = 0;
+        } else if (c.outOff > (1u << 20)) {
+            c.out.erase(0, c.outOff);
+            c.outOff = 0;
+        }
+    }
+
+    // 按连接状态调整关注的事件；读完且响应都已发出的连接关闭。
+    // 暂停读取且没有待发送数据的连接暂时移出 epoll，等引擎交回响应时再加回来
+    void settle(uint64_t key) {
+        auto it = conns.find(key);
+        if (it == conns.end()) return;
+        Conn& c = it->second;
+        bool pendingOut = c.outOff < c.out.size();
+        if (c.eof && c.inflight == 0 && !pendingOut) {
+            if (c.registered) ::epoll_ctl(ep, EPOLL_CTL_DEL, c.fd, nullptr);
+            ::close(c.fd);
+            conns.erase(it);
+            connCount.store(conns.size(), std::memory_order_relaxed);
+            return;
+        }
+        uint32_t events = 0;
+        if (!c.eof && c.inflight < maxInflight && c.out.size() - c.outOff < maxPendingOut) events |= EPOLLIN;
+        if (pendingOut) events |= EPOLLOUT;
+        if (events == 0) {
+            if (c.registered) ::epoll_ctl(ep, EPOLL_CTL_DEL, c.fd, nullptr);
+            c.registered = false;
+        } else if (!c.registered) {
+            watch(c.fd, key, events);
+            c.registered = true;
+        } else if (events != c.events) {
+            epoll_event ev{};
+            ev.events = events;
+            ev.data.u64 = key;
+            ::epoll_ctl(ep, EPOLL_CTL_MOD, c.fd, &ev);
+        }
+        c.events = events;
+    }
+
+    Post post;
+    std::string path;
+    int lfd = -1;
+    int ep = -1;
+    std::shared_ptr<Outbox> outbox;
+    std::thread th;
+    std::atomic<bool> quit{false};
+    std::unordered_map<uint64_t, Conn> conns;   // 只在 I/O 线程上访问
+    uint64_t nextKey = 2;
+#endif
+    std::atomic<unsigned long long> handled{0};
+    std::atomic<size_t> connCount{0};
+};
+
+// 客户端（阻塞套接字）：请求先累积在发送缓冲区，flush() 一次写出，再逐条 receive()
+class IpcClient {
+public:
+    IpcClient() = default;
+    IpcClient(const IpcClient&) = delete;
+    IpcClient& operator=(const IpcClient&) = delete;
+    ~IpcClient() { close(); }
+
+    bool connect(const std::string& socketPath) {
+#ifndef _WIN32
+        close();
+        sockaddr_un addr{};
+        if (socketPath.size() >= sizeof(addr.sun_path)) return false;
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+        if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+            close();
+            return false;
+        }
+        return true;
+#else
+        (void)socketPath;
+        return false;
+#endif
+    }
+
+    void close() {
+#ifndef _WIN32
+        if (fd >= 0) ::close(fd);
+#endif
+        fd = -1;
+        out.clear();
+        in.clear();
+        inOff = 0;
+    }
+
+    // 以下只追加到发送缓冲区，返回本条请求的 tag
+    // deadline 为提交后多少微秒内须完成，0 表示没有
+    uint32_t submit(std::string_view user, std::string_view doc, int pages, int priority = 0,
+                    int64_t deadline = 0) {
+        ipc::Request r;
+        r.op = ipc::Op::Submit;
+        r.user = std::string(user);
+        r.doc = std::string(doc);
+        r.pages = pages;
+        r.priority = priority;
+        r.deadline = deadline;
+        return queue(r);
+    }
+    uint32_t cancel(int id) { return queueId(ipc::Op::Cancel, id); }
+    uint32_t status(int id) { return queueId(ipc::Op::Status, id); }
+    uint32_t stats() {
+        ipc::Request r;
+        r.op = ipc::Op::Stats;
+        return queue(r);
+    }
+
+    bool flush() {
+#ifndef _WIN32
+        size_t off = 0;
+        while (off < out.size()) {
+            ssize_t n = ::send(fd, out.data() + off, out.size() - off, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            off += (size_t)n;
+        }
+        out.clear();
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // 阻塞读取下一条响应；连接断开或响应无法解析时返回 false
+    bool receive(ipc::Response& r) {
+#ifndef _WIN32
+        for (;;) {
+            const char* payload;
+            uint32_t len;
+            int k = ipc::nextFrame(in, inOff, &payload, &len);
+            if (k < 0) return false;
+            if (k > 0) {
+                r = ipc::Response();
+                bool ok = ipc::decode(payload, len, r);
+                inOff += 4 + (size_t)len;
+                if (inOff == in.size()) {
+                    in.clear();
+                    inOff = 0;
+                }
+                return ok;
+            }
+            if (inOff > 0) {
+                in.erase(0, inOff);
+                inOff = 0;
+            }
+            char buf[64 * 1024];
+            ssize_t n = ::read(fd, buf, sizeof(buf));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            in.append(buf, (size_t)n);
+        }
+#else
+        (void)r;
+        return false;
+#endif
+    }
+
+private:
+    uint32_t queue(ipc::Request& r) {
+        r.tag = nextTag++;
+        ipc::encode(out, r);
+        return r.tag;
+    }
+    uint32_t queueId(ipc::Op op, int id) {
+        ipc::Request r;
+        r.op = op;
+        r.id = id;
+        return queue(r);
+    }
+
+    int fd = -1;
+    uint32_t nextTag = 1;
+    std::string out;
+    std::string in;
+    size_t inOff = 0;
+};
+
+#endif // IPC_H
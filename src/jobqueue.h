@@ -0,0 +1,383 @@
+#ifndef JOBQUEUE_H
+#define JOBQUEUE_H
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
+
+// 等待队列的出队规则
+enum class QueueDiscipline {
+    Fifo = 0,            // 到达顺序
+    Priority,            // 优先级高者先（priority 越大越优先）
+    ShortestJob,         // 页数少者先（SJF）
+    ShortestRemaining,   // 剩余页数少者先（SRPT）
+    AgingPriority        // 优先级随等待时间线性增长，避免低优先级任务饿死
+};
+
+// 只比较规则的键：x 在前返回负数，y 在前返回正数，相同返回 0（相同时按到达顺序）。
+// 等待队列的堆与界面的等待表格共用这一比较，两边的顺序因此一致
+template <typename Job>
+int compareJobs(QueueDiscipline discipline, double agingRate, const Job& x, const Job& y) {
+    switch (discipline) {
+    case QueueDiscipline::Priority:
+        if (x.priority != y.priority) return x.priority > y.priority ? -1 : 1;
+        break;
+    case QueueDiscipline::ShortestJob:
+        if (x.pages != y.pages) return x.pages < y.pages ? -1 : 1;
+        break;
+    case QueueDiscipline::ShortestRemaining:
+        if (x.remainingPages() != y.remainingPages()) return x.remainingPages() < y.remainingPages() ? -1 : 1;
+        break;
+    case QueueDiscipline::AgingPriority: {
+        // 有效优先级 = priority + rate * (now - submitTime)；
+        // now 对所有任务相同，比较时可消去，因此堆键不随时间变化
+        double kx = x.priority - agingRate * x.submitTime;
+        double ky = y.priority - agingRate * y.submitTime;
+        if (kx != ky) return kx > ky ? -1 : 1;
+        break;
+    }
+    case QueueDiscipline::Fifo:
+        break;
+    }
+    return 0;
+}
+
+// 带 ID 索引的等待队列。
+// 任务按到达顺序存放在 items 中，id → 槽位下标 的哈希索引使按 ID
+// 查找和取消都是 O(1)：取消只把槽位标记为空（id = -1），不移动其它任务。
+// 队首前的空槽和中间的墓碑累积过多时整体压缩一次，均摊仍为 O(1)。
+// 遍历按到达顺序直接跳过墓碑，不复制任务。
+// 另外随增删维护队列中剩余页数的总和（pages），准入控制据此 O(1) 估算积压。
+//
+// 非 FIFO 规则下另外维护一个以槽位下标为元素的二叉堆（heapPos 记录每个
+// 槽位在堆中的位置），front()/pop()/remove() 均为 O(log n)。
+// Job 需提供 id、priority、pages、submitTime 字段和 remainingPages()。
+template <typename Job>
+struct IndexedQueue {
+    std::vector<Job> items;
+    size_t head = 0;                          // 第一个有效槽位
+    size_t count = 0;                         // 有效任务数
+    long long pages = 0;                      // 有效任务的剩余页数之和
+    std::unordered_map<int, size_t> index;    // id → 槽位
+
+    QueueDiscipline discipline = QueueDiscipline::Fifo;
+    double agingRate = 0.0;                   // AgingPriority：每等待一个时间单位（submitTime 的单位）提升的优先级
+    std::vector<size_t> heap;                 // 槽位下标组成的堆
+    std::vector<size_t> heapPos;              // 槽位 → 堆中位置
+    unsigned long long version = 0;           // 每次增删或改规则加一，供界面判断是否需要刷新
+
+    // —— 变化记录（界面增量刷新用）：trackChanges 打开时按顺序记下每次入队和移出。
+    // 入队序号 seq 单调递增，规则的键相同时按它排序，与槽位顺序（到达顺序）一致。
+    // changesLost 为 true 表示记录不完整（刚打开、改规则、清空或积压超过队列长度），
+    // 使用方应调用 resyncChanges() 整体重取一次
+    struct Change {
+        int id;
+        unsigned long long seq;   // 入队序号；0 表示移出
+    };
+    bool trackChanges = false;
+    bool changesLost = true;
+    std::vector<Change> changes;
+    unsigned long long nextSeq = 1;
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    void reserve(size_t n) {
+        items.reserve(n);
+        index.reserve(n);
+        if (heaped()) {
+            heap.reserve(n);
+            heapPos.reserve(n);
+        }
+    }
+
+    // 切换出队规则：重建堆，O(n)
+    void setDiscipline(QueueDiscipline d, double rate = 0.0) {
+        discipline = d;
+        agingRate = rate;
+        rebuildHeap();
+        ++version;
+        loseChanges();
+    }
+
+    // 按到达顺序交出全部任务和新编的入队序号 f(job, seq)，清空变化记录，之后从这里接着记
+    template <typename F>
+    void resyncChanges(F f) {
+        changes.clear();
+        changesLost = false;
+        for (size_t i = head; i < items.size(); ++i) {
+            if (items[i].id >= 0) f(items[i], nextSeq++);
+        }
+    }
+
+    void push(Job j) {
+        size_t i = items.size();
+        noteChange(j.id, nextSeq++);
+        index[j.id] = i;
+        pages += j.remainingPages();
+        items.push_back(std::move(j));
+        ++count;
+        ++version;
+        if (heaped()) {
+            heapPos.push_back(heap.size());
+            heap.push_back(i);
+            siftUp(heap.size() - 1);
+        }
+    }
+
+    // 批量入队（元素被移入）：预留一次容量，版本号只加一。
+    // 新增数量不少于已有数量时整体重建堆（O(n)），否则逐个上浮
+    template <typename It>
+    void pushRange(It first, It last) {
+        size_t n = (size_t)std::distance(first, last);
+        if (n == 0) return;
+        items.reserve(items.size() + n);
+        index.reserve(count + n);
+        bool rebuild = heaped() && n >= count;
+        for (; first != last; ++first) {
+            size_t i = items.size();
+            noteChange(first->id, nextSeq++);
+            index[first->id] = i;
+            pages += first->remainingPages();
+            items.push_back(std::move(*first));
+            ++count;
+            if (heaped() && !rebuild) {
+                heapPos.push_back(heap.size());
+                heap.push_back(i);
+                siftUp(heap.size() - 1);
+            }
+        }
+        if (rebuild) rebuildHeap();
+        ++version;
+    }
+
+    // 按当前规则的下一个任务
+    Job& front() { return items[heaped() ? heap[0] : head]; }
+    const Job& front() const { return items[heaped() ? heap[0] : head]; }
+
+    void pop() {
+        if (count == 0) return;
+        remove(front().id);
+    }
+
+    // 按当前规则 x 是否严格排在 y 之前（不看到达顺序；FIFO 下恒为 false）。
+    // y 可以是不在队列中的任务，例如正在打印的任务（抢占判断用）
+    bool outranks(const Job& x, const Job& y) const {
+        return compare(x, y) < 0;
+    }
+
+    const Job* find(int id) const {
+        auto it = index.find(id);
+        return it == index.end() ? nullptr : &items[it->second];
+    }
+    Job* find(int id) {
+        auto it = index.find(id);
+        return it == index.end() ? nullptr : &items[it->second];
+    }
+
+    // 按 ID 删除；out 非空时把被删除的任务移出
+    bool remove(int id, Job* out = nullptr) {
+        auto it = index.find(id);
+        if (it == index.end()) return false;
+        size_t i = it->second;
+        index.erase(it);
+        noteChange(id, 0);
+        if (heaped()) heapErase(heapPos[i]);
+        pages -= items[i].remainingPages();
+        if (out) *out = std::move(items[i]);
+        items[i] = Job();       // 墓碑：id = -1
+        --count;
+        ++version;
+        if (i == head) skipDead();
+        maybeCompact();
+        return true;
+    }
+
+    // 批量删除满足 pred(const Job&) 的任务，被删除的 ID 按到达顺序追加到 removed。
+    // 只打墓碑，最后统一压缩、重建一次堆：O(n)，而不是每个 O(log n) 再加上多次压缩
+    template <typename Pred>
+    size_t removeIf(Pred pred, std::vector<int>* removed = nullptr) {
+        size_t n = 0;
+        for (size_t i = head; i < items.size(); ++i) {
+            if (items[i].id < 0 || !pred(static_cast<const Job&>(items[i]))) continue;
+            if (removed) removed->push_back(items[i].id);
+            noteChange(items[i].id, 0);
+            index.erase(items[i].id);
+            pages -= items[i].remainingPages();
+            items[i] = Job();
+            --count;
+            ++n;
+        }
+        if (n == 0) return 0;
+        ++version;
+        skipDead();
+        if (!maybeCompact()) rebuildHeap();
+        return n;
+    }
+
+    void clear() {
+        items.clear();
+        index.clear();
+        heap.clear();
+        heapPos.clear();
+        head = 0;
+        count = 0;
+        pages = 0;
+        ++version;
+        loseChanges();
+    }
+
+    // 按出队顺序排好的副本（仅用于显示；FIFO 为 O(n)，其它规则 O(n log n)）
+    std::vector<Job> ordered() const {
+        std::vector<Job> out;
+        out.reserve(count);
+        for (size_t i : orderedSlots()) out.push_back(items[i]);
+        return out;
+    }
+
+    // 按出队顺序的 ID 列表
+    std::vector<int> orderedIds() const {
+        std::vector<int> out;
+        out.reserve(count);
+        for (size_t i : orderedSlots()) out.push_back(items[i].id);
+        return out;
+    }
+
+    // —— 只读遍历（到达顺序，跳过墓碑）
+    struct const_iterator {
+        const std::vector<Job>* v;
+        size_t i;
+        const Job& operator*() const { return (*v)[i]; }
+        const Job* operator->() const { return &(*v)[i]; }
+        const_iterator& operator++() {
+            ++i;
+            while (i < v->size() && (*v)[i].id < 0) ++i;
+            return *this;
+        }
+        bool operator==(const const_iterator& o) const { return i == o.i; }
+        bool operator!=(const const_iterator& o) const { return i != o.i; }
+    };
+    const_iterator begin() const { return {&items, count ? head : items.size()}; }
+    const_iterator end() const { return {&items, items.size()}; }
+
+private:
+    bool heaped() const { return discipline != QueueDiscipline::Fifo; }
+
+    void noteChange(int id, unsigned long long seq) {
+        if (!trackChanges || changesLost) return;
+        changes.push_back({id, seq});
+        if (changes.size() > 2 * count + 1024) loseChanges();   // 比整体重取还贵：放弃增量
+    }
+
+    void loseChanges() {
+        changesLost = true;
+        changes.clear();
+        changes.shrink_to_fit();
+    }
+
+    std::vector<size_t> orderedSlots() const {
+        std::vector<size_t> order;
+        order.reserve(count);
+        for (size_t i = head; i < items.size(); ++i) {
+            if (items[i].id >= 0) order.push_back(i);
+        }
+        if (heaped()) {
+            std::sort(order.begin(), order.end(),
+                      [this](size_t a, size_t b) { return before(a, b); });
+        }
+        return order;
+    }
+
+    // 槽位 a 是否应排在 b 之前；同等条件下按到达顺序
+    bool before(size_t a, size_t b) const {
+        int c = compare(items[a], items[b]);
+        return c != 0 ? c < 0 : a < b;
+    }
+
+    int compare(const Job& x, const Job& y) const {
+        return compareJobs(discipline, agingRate, x, y);
+    }
+
+    void heapSwap(size_t p, size_t q) {
+        std::swap(heap[p], heap[q]);
+        heapPos[heap[p]] = p;
+        heapPos[heap[q]] = q;
+    }
+
+    void siftUp(size_t p) {
+        while (p > 0) {
+            size_t parent = (p - 1) / 2;
+            if (!before(heap[p], heap[parent])) break;
+            heapSwap(p, parent);
+            p = parent;
+        }
+    }
+
+    void siftDown(size_t p) {
+        for (;;) {
+            size_t l = 2 * p + 1, r = l + 1, best = p;
+            if (l < heap.size() && before(heap[l], heap[best])) best = l;
+            if (r < heap.size() && before(heap[r], heap[best])) best = r;
+            if (best == p) return;
+            heapSwap(p, best);
+            p = best;
+        }
+    }
+
+    void heapErase(size_t p) {
+        size_t last = heap.size() - 1;
+        if (p != last) {
+            heapSwap(p, last);
+            heap.pop_back();
+            siftDown(p);
+            siftUp(p);
+        } else {
+            heap.pop_back();
+        }
+    }
+
+    void rebuildHeap() {
+        heap.clear();
+        heapPos.clear();
+        if (!heaped()) return;
+        heapPos.assign(items.size(), 0);
+        for (size_t i = head; i < items.size(); ++i) {
+            if (items[i].id < 0) continue;
+            heapPos[i] = heap.size();
+            heap.push_back(i);
+        }
+        for (size_t p = heap.size() / 2; p-- > 0;) siftDown(p);
+    }
+
+    void skipDead() {
+        while (head < items.size() && items[head].id < 0) ++head;
+        if (count == 0) {           // 队列已空：直接复位，免去压缩
+            items.clear();
+            heap.clear();
+            heapPos.clear();
+            head = 0;
+        }
+    }
+
+    // 墓碑（含队首之前的空槽）超过一半且数量可观时压缩；返回是否压缩了
+    bool maybeCompact() {
+        size_t dead = items.size() - count;
+        if (dead < 1024 || dead < count) return false;
+        size_t w = 0;
+        for (size_t r = head; r < items.size(); ++r) {
+            if (items[r].id < 0) continue;
+            if (w != r) items[w] = std::move(items[r]);
+            index[items[w].id] = w;
+            ++w;
+        }
+        items.resize(w);
+        head = 0;
+        rebuildHeap();   // 槽位下标已改变
+        return true;
+    }
+};
+
+#endif // JOBQUEUE_H
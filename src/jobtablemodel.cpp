@@ -0,0 +1,206 @@
+#include "jobtablemodel.h"
+
+#include <algorithm>
+
+// ========== 已完成任务 ==========
+
+DoneTableModel::DoneTableModel(const DoneMirror& done, QObject *parent)
+    : QAbstractTableModel(parent), done(done)
+{
+}
+
+int DoneTableModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : shown;
+}
+
+int DoneTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : 8;
+}
+
+QVariant DoneTableModel::data(const QModelIndex& index, int role) const
+{
+    if (role != Qt::DisplayRole || !index.isValid() || index.row() >= shown) return QVariant();
+    const auto& j = done.jobs[index.row()];
+    switch (index.column()) {
+    case 0: return j.id;
+    case 1: return toQString(j.userName());
+    case 2: return toQString(j.docName());
+    case 3: return pagesText(j);
+    case 4: return QString::fromStdString(PrintManager::fmt(j.submitTime));
+    case 5: return QString::fromStdString(PrintManager::fmt(j.startTime));
+    case 6: return QString::fromStdString(PrintManager::fmt(j.finishTime));
+    case 7: return QString("%1 / %2").arg(j.waitSec(), 0, 'g', 6).arg(j.durationSec(), 0, 'g', 6);
+    }
+    return QVariant();
+}
+
+QVariant DoneTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    static const char *headers[] = {"ID", "用户", "文档名", "页数", "提交时间", "开始时间", "结束时间", "等待/耗时(秒)"};
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal || section < 0 || section >= 8) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    return QString(headers[section]);
+}
+
+void DoneTableModel::sync()
+{
+    // 视图中的行必须与副本首尾相接，否则（重新加载、跳过了一段）整体重置
+    if (done.first < shownFirst || done.first > shownFirst + shown || done.end() < shownFirst + shown) {
+        reload();
+        return;
+    }
+    int drop = (int)(done.first - shownFirst);
+    if (drop > 0) {
+        beginRemoveRows(QModelIndex(), 0, drop - 1);
+        shown -= drop;
+        shownFirst = done.first;
+        endRemoveRows();
+    }
+    int n = (int)done.jobs.size();
+    if (n > shown) {
+        beginInsertRows(QModelIndex(), shown, n - 1);
+        shown = n;
+        endInsertRows();
+    }
+}
+
+void DoneTableModel::reload()
+{
+    beginResetModel();
+    shownFirst = done.first;
+    shown = (int)done.jobs.size();
+    endResetModel();
+}
+
+// ========== 等待队列 ==========
+
+WaitingTableModel::WaitingTableModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+int WaitingTableModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : (int)ids.size();
+}
+
+int WaitingTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : 6;
+}
+
+QVariant WaitingTableModel::data(const QModelIndex& index, int role) const
+{
+    if (role != Qt::DisplayRole || !index.isValid() || index.row() >= (int)ids.size()) return QVariant();
+    auto it = rows.find(ids[index.row()]);
+    if (it == rows.end()) return QVariant();
+    const PrintJob *j = &it->second.job;
+    switch (index.column()) {
+    case 0: return j->id;
+    case 1: return toQString(j->userName());
+    case 2: return toQString(j->docName());
+    case 3: return pagesText(*j);
+    case 4: return QString::fromStdString(PrintManager::fmt(j->submitTime));
+    case 5: return j->priority;
+    }
+    return QVariant();
+}
+
+QVariant WaitingTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    static const char *headers[] = {"ID", "用户", "文档名", "页数", "提交时间", "优先级"};
+    if (role != Qt::DisplayRole || orientation != Qt::Horizontal || section < 0 || section >= 6) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    return QString(headers[section]);
+}
+
+bool WaitingTableModel::less(const Row& a, const Row& b) const
+{
+    int c = compareJobs(discipline, agingRate, a.job, b.job);
+    return c != 0 ? c < 0 : a.seq < b.seq;
+}
+
+// 第一个不排在 key 之前的行
+size_t WaitingTableModel::lowerBound(const Row& key) const
+{
+    auto it = std::lower_bound(ids.begin(), ids.end(), key, [this](int id, const Row& k) {
+        return less(rows.at(id), k);
+    });
+    return (size_t)(it - ids.begin());
+}
+
+unsigned long long WaitingTableModel::sync(const SimSnapshot& snap)
+{
+    for (const auto& d : snap.waitingDeltas) {
+        if (d->version > version) apply(*d);
+    }
+    return version;
+}
+
+void WaitingTableModel::apply(const WaitingDelta& d)
+{
+    version = d.version;
+    if (d.reset) {
+        beginResetModel();
+        discipline = d.discipline;
+        agingRate = d.agingRate;
+        rows.clear();
+        ids.clear();
+        ids.reserve(d.added.size());
+        for (const auto& a : d.added) {
+            rows.emplace(a.second.id, Row{a.first, a.second});
+            ids.push_back(a.second.id);
+        }
+        std::sort(ids.begin(), ids.end(), [this](int x, int y) { return less(rows.at(x), rows.at(y)); });
+        endResetModel();
+        return;
+    }
+
+    // 删除：定位后从后往前按连续段发出
+    std::vector<size_t> gone;
+    gone.reserve(d.removed.size());
+    for (int id : d.removed) {
+        auto it = rows.find(id);
+        if (it != rows.end()) gone.push_back(lowerBound(it->second));
+    }
+    std::sort(gone.begin(), gone.end());
+    for (size_t e = gone.size(); e > 0;) {
+        size_t b = e - 1;
+        while (b > 0 && gone[b - 1] + 1 == gone[b]) --b;
+        size_t first = gone[b], last = gone[e - 1];
+        beginRemoveRows(QModelIndex(), (int)first, (int)last);
+        for (size_t r = first; r <= last; ++r) rows.erase(ids[r]);
+        ids.erase(ids.begin() + first, ids.begin() + last + 1);
+        endRemoveRows();
+        e = b;
+    }
+
+    // 插入：新行排好序，落在同一空隙的一批一起插入
+    std::vector<Row> add;
+    add.reserve(d.added.size());
+    for (const auto& a : d.added) add.push_back(Row{a.first, a.second});
+    std::sort(add.begin(), add.end(), [this](const Row& x, const Row& y) { return less(x, y); });
+    std::vector<size_t> at(add.size());
+    for (size_t k = 0; k < add.size(); ++k) at[k] = lowerBound(add[k]);   // 相对插入前的行
+    size_t inserted = 0;
+    for (size_t b = 0; b < add.size();) {
+        size_t e = b + 1;
+        while (e < add.size() && at[e] == at[b]) ++e;
+        size_t row = at[b] + inserted;
+        beginInsertRows(QModelIndex(), (int)row, (int)(row + (e - b) - 1));
+        std::vector<int> batch;
+        batch.reserve(e - b);
+        for (size_t k = b; k < e; ++k) {
+            batch.push_back(add[k].job.id);
+            rows.emplace(add[k].job.id, std::move(add[k]));
+        }
+        ids.insert(ids.begin() + row, batch.begin(), batch.end());
+        endInsertRows();
+        inserted += e - b;
+        b = e;
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef JOBTABLEMODEL_H
+#define JOBTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "printmanager.h"
+#include "simworker.h"
+
+// 字符串池中的用户名/文档名转成界面字符串
+inline QString toQString(std::string_view s)
+{
+    return QString::fromUtf8(s.data(), (int)s.size());
+}
+
+// 页数列：拆分任务的分段注明母任务和页码区间
+inline QVariant pagesText(const PrintJob& j)
+{
+    if (j.parent == 0) return j.pages;
+    return QString("%1（#%2 第%3-%4页）").arg(j.pages).arg(j.parent).arg(j.firstPage).arg(j.firstPage + j.pages - 1);
+}
+
+// 已完成任务表格的模型：直接读取界面线程维护的完成记录副本（由快照增量追加），不再复制。
+// 该副本只在末尾追加、在头部逐出（随引擎的保留窗口滑动），sync() 只为新增的行
+// 发出 rowsInserted、为逐出的行发出 rowsRemoved；视图只绘制可见行，
+// 因此刷新代价与变化的行数成正比，与历史总量无关。
+// 查询结果整体替换副本内容后调用 reload()。
+class DoneTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    DoneTableModel(const DoneMirror& done, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void sync();
+    void reload();
+
+private:
+    const DoneMirror& done;
+    uint64_t shownFirst = 0;   // 视图第一行的全局序号
+    int shown = 0;             // 视图已知的行数
+};
+
+// 等待队列表格的模型：应用后台线程发布的等待队列增量（WaitingDelta），自己维护出队顺序。
+// 行按 (排队规则的键, 入队序号) 排序，与引擎的出队顺序一致；删除和插入都用二分查找定位，
+// 只对变化的行发出 rowsRemoved / rowsInserted，代价与变化的行数成正比（另加移动 ID 数组）。
+// 切换排队规则或积压过多时后台线程发来整体重取的段，这时才重置模型。
+class WaitingTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit WaitingTableModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // 应用快照中尚未应用的段；返回已应用到的队列版本，供 SimWorker::ackWaiting()
+    unsigned long long sync(const SimSnapshot& snap);
+
+private:
+    struct Row {
+        unsigned long long seq;   // 入队序号
+        PrintJob job;
+    };
+    bool less(const Row& a, const Row& b) const;
+    size_t lowerBound(const Row& key) const;
+    void apply(const WaitingDelta& d);
+
+    std::unordered_map<int, Row> rows;   // id → 行内容
+    std::vector<int> ids;                // 当前显示的行（任务 ID，按出队顺序）
+    QueueDiscipline discipline = QueueDiscipline::Fifo;
+    double agingRate = 0.0;
+    unsigned long long version = 0;
+};
+
+#endif // JOBTABLEMODEL_H
@@ -0,0 +1,182 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <cstdio>
+#include <string>
+#include <chrono>
+#include <utility>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// 预写日志（write-ahead journal）：每个事件追加一行，代价 O(1)。
+// 快照（data/*.csv）定期整体重写一次，之后日志截断重新开始，
+// 日志首行记录所属快照的 epoch，恢复时只重放与快照 epoch 相同的日志。
+//
+// 行格式（字段用 csvEscape 转义；时刻和时长为十进制秒，见 simtime.h）：
+//   A,id,submitTime,user,doc,pages,priority[,chunks[,deadline]]
+//                                    新任务（submitTime 可在未来；chunks 为拆分的段数）
+//   C,id,time                        取消任务
+//   H,id,time / U,id,time            暂停 / 恢复任务
+//   S,id,time,printSec,printer       任务开始打印（按当时速度所需的打印时长）
+//   F,id,time,printer                任务完成
+//   R,id,time,printer                任务在页边界被抢占
+//   V,time,secPerPage                修改速度
+//   P,time,printer,secPerPage        修改单台打印机的速度
+//   N,time,count / D,time,policy     修改打印机数量 / 调度策略
+//   Q,time,discipline,agingRate      修改出队规则
+//   E,time,0|1 / K,time,pages        抢占开关 / 拆分阈值
+//   L,time,admission,queueLimit      准入策略与等待队列长度上限
+//   M,id,time,0|1                    预约任务到达时被准入控制拒绝（0）/ 降级（1）
+//   T,time                           时钟推进到 time（推进中处理过事件、跨过整 clockLogEvery（默认一分钟）或空转之后提交任务时记录）
+struct Journal {
+    // 持久化策略：何时把缓冲区 fsync 到磁盘
+    enum class Durability {
+        EveryEvent,   // 每个事件都 fsync（最安全，最慢）
+        Interval,     // 距上次同步超过 intervalMs 才 fsync
+        OnShutdown    // 只在快照 / 关闭时 fsync
+    };
+
+    std::string path = "data/journal.log";
+    Durability durability = Durability::Interval;
+    int intervalMs = 200;
+
+    std::FILE* fp = nullptr;
+    std::string buf;              // 尚未写出的日志行
+    long long epoch = 0;          // 当前日志对应的快照编号
+    long long events = 0;         // 自上次快照以来的事件数
+    int batchDepth = 0;           // >0 时处于批量操作中：只缓冲，结束时按策略同步一次
+    unsigned long long bytesWritten = 0;
+    std::chrono::steady_clock::time_point lastSync = std::chrono::steady_clock::now();
+
+    static constexpr size_t kMaxBuffer = 64 * 1024;  // 缓冲超过此值先写给操作系统
+
+    Journal() = default;
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+    Journal(Journal&& o) noexcept { *this = std::move(o); }
+    Journal& operator=(Journal&& o) noexcept {
+        if (this != &o) {
+            close();
+            path = std::move(o.path);
+            durability = o.durability;
+            intervalMs = o.intervalMs;
+            fp = o.fp; o.fp = nullptr;
+            buf = std::move(o.buf);
+            epoch = o.epoch;
+            events = o.events;
+            batchDepth = o.batchDepth;
+            bytesWritten = o.bytesWritten;
+            lastSync = o.lastSync;
+        }
+        return *this;
+    }
+    ~Journal() { close(); }
+
+    bool isOpen() const { return fp != nullptr; }
+
+    // 以追加方式打开；新文件写入 epoch 头
+    bool open() {
+        if (fp) return true;
+        fp = std::fopen(path.c_str(), "ab");
+        if (!fp) return false;
+        std::fseek(fp, 0, SEEK_END);
+        if (std::ftell(fp) == 0) writeHeader();
+        return true;
+    }
+
+    void close() {
+        if (!fp) return;
+        flush(true);
+        std::fclose(fp);
+        fp = nullptr;
+    }
+
+    // 快照完成后调用：截断日志并开始新的 epoch
+    void reset(long long newEpoch) {
+        buf.clear();
+        if (fp) std::fclose(fp);
+        epoch = newEpoch;
+        events = 0;
+        fp = std::fopen(path.c_str(), "wb");
+        if (!fp) return;
+        writeHeader();
+        flush(true);
+    }
+
+    // 追加一行（不含换行）
+    void append(const std::string& line) {
+        if (!fp && !open()) return;
+        buf += line;
+        buf += '\n';
+        ++events;
+        if (batchDepth > 0) {
+            if (buf.size() >= kMaxBuffer) flush(false);
+            return;
+        }
+        applyDurability();
+    }
+
+    // 批量操作：其间追加的行只进缓冲区，endBatch() 时整批按持久化策略同步一次
+    // （EveryEvent 下一批只 fsync 一次）。可以嵌套
+    void beginBatch() {
+        ++batchDepth;
+    }
+    void endBatch() {
+        if (batchDepth > 0 && --batchDepth == 0) applyDurability();
+    }
+
+    // 定时调用：Interval 策略下到期则同步
+    void poll() {
+        if (durability != Durability::Interval || buf.empty()) return;
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastSync >= std::chrono::milliseconds(intervalMs)) {
+            flush(true);
+        } else if (buf.size() >= kMaxBuffer) {
+            flush(false);
+        }
+    }
+
+    // 按持久化策略处理缓冲区中的新行
+    void applyDurability() {
+        switch (durability) {
+        case Durability::EveryEvent:
+            flush(true);
+            break;
+        case Durability::Interval:
+            poll();
+            break;
+        case Durability::OnShutdown:
+            if (buf.size() >= kMaxBuffer) flush(false);
+            break;
+        }
+    }
+
+    // 把缓冲写给操作系统；sync 为真时再 fsync
+    void flush(bool sync) {
+        if (!fp) return;
+        if (!buf.empty()) {
+            std::fwrite(buf.data(), 1, buf.size(), fp);
+            bytesWritten += buf.size();
+            buf.clear();
+        }
+        std::fflush(fp);
+        if (sync) {
+#ifdef _WIN32
+            _commit(_fileno(fp));
+#else
+            fsync(fileno(fp));
+#endif
+            lastSync = std::chrono::steady_clock::now();
+        }
+    }
+
+private:
+    void writeHeader() {
+        buf.insert(0, "# epoch " + std::to_string(epoch) + "\n");
+    }
+};
+
+#endif // JOURNAL_H
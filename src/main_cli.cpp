@@ -0,0 +1,604 @@
+// 无界面的批量仿真入口：读入任务轨迹，全速跑完，输出完成记录和汇总统计。
+// 不依赖 Qt，可在没有显示器的服务器上运行。
+//
+// 用法: PrintManagerCLI <trace.csv> [选项]
+//       PrintManagerCLI --generate <规格> [选项] [--trace-out FILE]
+//       PrintManagerCLI --sweep <规格> [--speeds ..] [--rates ..] [--printers ..] [--disciplines ..]
+//       PrintManagerCLI --export <done.bin> <out.csv> [--from T1] [--to T2]
+//       PrintManagerCLI --serve <socket> [--data DIR] [--pace X] [--printers N] [--speed SEC]
+// 轨迹文件每行 user,doc,pages,submitTime[,priority[,deadline]]，首行为表头时自动跳过；
+// 时刻以秒计，可带小数；deadline 为绝对截止时刻，留空或为负表示没有。
+// --generate 按工作负载规格（见 workload.h）边生成边仿真，--trace-out 同时把生成的任务写成轨迹文件。
+// --sweep 在参数网格上多线程重复仿真，输出各点的均值和 95% 置信区间。
+// --export 把二进制完成日志（按完成时间区间）导出为 CSV，不需要跑仿真。
+// --serve 作为常驻服务运行：在 Unix 域套接字上接受提交/取消/查询（协议见 ipc.h），
+// 数据目录的快照和日志照常读写，收到 SIGINT/SIGTERM 时做完整快照后退出。
+// --metrics-port 在运行期间于 127.0.0.1 上提供 Prometheus 格式的 /metrics，
+// --metrics-out 在结束时把同样的内容写到文件（见 metrics.h）。
+
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "printmanager.h"
+#include "workload.h"
+#include "sweep.h"
+#include "simworker.h"
+#include "ipc.h"
+
+static void usage(const char *prog)
+{
+    std::fprintf(stderr,
+        "用法: %s <trace.csv> [选项]\n"
+        "      %s --generate <规格> [选项]\n"
+        "  --printers N          打印机数量（默认 1）\n"
+        "  --speed SEC           打印速度，秒/页（默认 2.0）\n"
+        "  --policy P            调度策略 fifo|sjf|least|fair（默认 fifo）\n"
+        "  --discipline D        排队规则 fifo|priority|sjf|srpt|aging（默认 fifo）\n"
+        "  --aging RATE          老化优先级每秒提升量（默认 0.01）\n"
+        "  --preempt on|off      页边界抢占：排在前面的任务在当前页打完后接替正在打印的任务（默认 off）\n"
+        "  --split PAGES         超过 PAGES 页的任务按页码区间拆分，分段同时在多台打印机上打印（默认 0，不拆分）\n"
+        "  --admission A         准入控制 off|reject|demote：预计赶不上截止时刻的任务拒绝或降到最低优先级（默认 off）\n"
+        "  --queue-limit N       等待队列长度上限，队列满时拒绝新提交（默认 0，不限）\n"
+        "  --done FILE           完成记录输出文件（默认 done_out.csv）\n"
+        "  --summary FILE        汇总统计输出文件（默认标准输出）\n"
+        "  --trace-out FILE      （--generate）把生成的任务另存为轨迹文件\n"
+        "  --metrics-out FILE    结束时把运行时指标写成 Prometheus 文本\n"
+        "  --metrics-port PORT   运行期间在 127.0.0.1:PORT 提供 /metrics\n"
+        "  规格示例: seed=7,jobs=100000,arrival=mmpp,rate=0.2,burst=3,users=200,zipf=1.1,pages=pareto:1.6:1,max=300\n"
+        "\n"
+        "用法: %s --sweep <规格> [选项]\n"
+        "  --speeds A,B,..       打印速度网格（秒/页，默认 2.0）\n"
+        "  --rates A,B,..        到达率网格（每秒，默认取规格中的 rate）\n"
+        "  --printers A,B,..     打印机数量网格（默认 1）\n"
+        "  --disciplines A,B,..  排队规则网格（默认 fifo）\n"
+        "  --policy P / --aging RATE / --preempt on|off / --split PAGES   同上\n"
+        "  --admission A / --queue-limit N                                  同上\n"
+        "  --reps N              每个点的重复次数（默认 10）\n"
+        "  --threads N           工作线程数（默认 CPU 核数）\n"
+        "  --out FILE            结果 CSV（默认标准输出）\n"
+        "\n"
+        "用法: %s --export <done.bin> <out.csv> [--from T1] [--to T2]\n"
+        "  导出完成时间在 [T1, T2] 内的记录；字符串从同目录同名的 .str 文件读取\n"
+        "\n"
+        "用法: %s --serve <socket> [选项]\n"
+        "  --data DIR            数据目录（默认 data）\n"
+        "  --pace X              实时模式倍速（默认 0，即时钟只随 tick 命令前进）\n"
+        "  --printers N / --speed SEC / --preempt on|off / --split PAGES / --admission A / --queue-limit N\n"
+        "                        启动后设置打印机数量、速度、抢占、拆分阈值和准入控制（默认沿用恢复的状态）\n"
+        "  --metrics-port PORT   同时在 127.0.0.1:PORT 提供 /metrics\n",
+        prog, prog, prog, prog, prog);
+}
+
+static bool parsePolicy(const std::string& s, DispatchPolicy& p)
+{
+    if (s == "fifo") p = DispatchPolicy::Fifo;
+    else if (s == "sjf") p = DispatchPolicy::ShortestJobFirst;
+    else if (s == "least") p = DispatchPolicy::LeastLoaded;
+    else if (s == "fair") p = DispatchPolicy::FairShare;
+    else return false;
+    return true;
+}
+
+static bool parseDiscipline(const std::string& s, QueueDiscipline& d)
+{
+    if (s == "fifo") d = QueueDiscipline::Fifo;
+    else if (s == "priority") d = QueueDiscipline::Priority;
+    else if (s == "sjf") d = QueueDiscipline::ShortestJob;
+    else if (s == "srpt") d = QueueDiscipline::ShortestRemaining;
+    else if (s == "aging") d = QueueDiscipline::AgingPriority;
+    else return false;
+    return true;
+}
+
+static bool parseSwitch(const std::string& s, bool& on)
+{
+    if (s == "on" || s == "1") on = true;
+    else if (s == "off" || s == "0") on = false;
+    else return false;
+    return true;
+}
+
+static bool parseAdmission(const std::string& s, AdmissionPolicy& a)
+{
+    if (s == "off") a = AdmissionPolicy::Off;
+    else if (s == "reject") a = AdmissionPolicy::Reject;
+    else if (s == "demote") a = AdmissionPolicy::Demote;
+    else return false;
+    return true;
+}
+
+// 流式读取轨迹，每攒够一批用 addJobs 提交；返回读入的任务数，文件打不开时返回 -1
+static long long loadTrace(PrintManager& pm, const std::string& path)
+{
+    CsvReader in(path);
+    if (!in.isOpen()) return -1;
+    StringPool& strings = StringPool::global();
+    std::vector<JobSpec> batch;
+    batch.reserve(4096);
+    std::vector<std::string_view> f;
+    long long n = 0, line = 0;
+    while (in.next(f)) {
+        ++line;
+        if (f.size() < 4) continue;
+        int pages = CsvReader::toInt(f[2], -1);
+        SimTime submit = parseTime(f[3], -1);
+        if (pages <= 0 || submit < 0) {
+            if (line > 1) std::fprintf(stderr, "跳过第 %lld 行：页数或提交时间无效\n", line);
+            continue;   // 第一行通常是表头
+        }
+        JobSpec spec;
+        spec.user = strings.internUser(f[0]);
+        spec.doc = strings.addDoc(f[1]);
+        spec.pages = pages;
+        spec.submitTime = submit;
+        spec.priority = f.size() > 4 ? CsvReader::toInt(f[4], 0) : 0;
+        spec.deadline = f.size() > 5 ? parseTime(f[5], -1) : -1;
+        batch.push_back(spec);
+        if (batch.size() == batch.capacity()) {
+            pm.addJobs(batch);
+            batch.clear();
+        }
+        ++n;
+    }
+    pm.addJobs(batch);
+    return n;
+}
+
+static void writeSummary(std::ostream& out, const PrintManager& pm, long long jobs, double seconds)
+{
+    auto s = pm.getStatistics();
+    out << "jobs," << jobs << "\n"
+        << "completed," << s.totalCompleted << "\n"
+        << "makespan," << timeToSec(pm.currentTime) << "\n"
+        << "avgWait," << s.avgWaitTime << "\n"
+        << "stdWait," << s.stdWaitTime << "\n"
+        << "maxWait," << s.maxWaitTime << "\n"
+        << "p50Wait," << s.p50Wait << "\n"
+        << "p95Wait," << s.p95Wait << "\n"
+        << "p99Wait," << s.p99Wait << "\n"
+        << "avgDuration," << s.avgDuration << "\n"
+        << "stdDuration," << s.stdDuration << "\n"
+        << "p50Duration," << s.p50Duration << "\n"
+        << "p95Duration," << s.p95Duration << "\n"
+        << "p99Duration," << s.p99Duration << "\n"
+        << "utilisation," << s.utilisation << "\n"
+        << "preemptions," << pm.preemptCount << "\n"
+        << "deadlineJobs," << s.deadlineJobs << "\n"
+        << "onTimePct," << s.onTimePct << "\n"
+        << "p50Lateness," << s.p50Lateness << "\n"
+        << "p95Lateness," << s.p95Lateness << "\n"
+        << "p99Lateness," << s.p99Lateness << "\n"
+        << "queueLimit," << s.queueLimit << "\n"
+        << "rejected," << s.rejected << "\n"
+        << "demoted," << s.demoted << "\n";
+    for (const auto& p : s.printers) {
+        out << "printer" << p.id + 1 << ".utilisation," << p.utilisation << "\n"
+            << "printer" << p.id + 1 << ".jobsDone," << p.jobsDone << "\n"
+            << "printer" << p.id + 1 << ".pagesDone," << p.pagesDone << "\n"
+            << "printer" << p.id + 1 << ".jobsPerHour," << p.jobsPerHour << "\n";
+    }
+    out << "wallSeconds," << seconds << "\n";
+}
+
+// --export 模式：直接映射 done.bin，整块跳过区间外的数据
+static int exportDone(int argc, char *argv[])
+{
+    if (argc < 4) {
+        usage(argv[0]);
+        return 1;
+    }
+    std::string binPath = argv[2];
+    std::string outPath = argv[3];
+    SimTime from = LLONG_MIN, to = LLONG_MAX;
+    for (int i = 4; i < argc; ++i) {
+        std::string opt = argv[i];
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "选项 %s 缺少参数\n", opt.c_str());
+            return 1;
+        }
+        std::string val = argv[++i];
+        if (opt == "--from") from = parseTime(val);
+        else if (opt == "--to") to = parseTime(val);
+        else {
+            std::fprintf(stderr, "未知选项 %s\n", opt.c_str());
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::string strPath = binPath;
+    size_t dot = strPath.rfind('.');
+    if (dot != std::string::npos && strPath.find('/', dot) == std::string::npos) strPath.erase(dot);
+    strPath += ".str";
+
+    DoneLogReader in;
+    if (!donelog::upgrade(binPath) || !in.open(binPath, strPath)) {
+        std::fprintf(stderr, "无法打开完成日志 %s\n", binPath.c_str());
+        return 1;
+    }
+    if (!in.exportCsv(outPath, from, to)) {
+        std::fprintf(stderr, "无法写入 %s\n", outPath.c_str());
+        return 1;
+    }
+    return 0;
+}
+
+// 逗号分隔的列表，每一项由 parse 转换；有一项无效即失败
+template <typename T, typename F>
+static bool parseList(const std::string& s, std::vector<T>& out, F parse)
+{
+    out.clear();
+    size_t from = 0;
+    for (;;) {
+        size_t at = s.find(',', from);
+        T v;
+        if (!parse(s.substr(from, at == std::string::npos ? std::string::npos : at - from), v)) return false;
+        out.push_back(v);
+        if (at == std::string::npos) return true;
+        from = at + 1;
+    }
+}
+
+static const char *disciplineName(QueueDiscipline d)
+{
+    static const char *names[] = {"fifo", "priority", "sjf", "srpt", "aging"};
+    return names[(int)d];
+}
+
+// --sweep 模式
+static int runSweep(int argc, char *argv[])
+{
+    if (argc < 3) {
+        usage(argv[0]);
+        return 1;
+    }
+    SweepConfig cfg;
+    std::string err;
+    if (!WorkloadSpec::parse(argv[2], cfg.workload, &err)) {
+        std::fprintf(stderr, "工作负载规格无效: %s\n", err.c_str());
+        return 1;
+    }
+    if (cfg.workload.jobs == 0) {
+        std::fprintf(stderr, "参数扫描需要有限的任务数（jobs=N）\n");
+        return 1;
+    }
+    auto positive = [](const std::string& t, double& v) { return (v = std::atof(t.c_str())) > 0; };
+    auto count = [](const std::string& t, int& v) { return (v = std::atoi(t.c_str())) > 0; };
+    ParameterSweep sweep;
+    std::string outPath;
+    for (int i = 3; i < argc; ++i) {
+        std::string opt = argv[i];
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "选项 %s 缺少参数\n", opt.c_str());
+            return 1;
+        }
+        std::string val = argv[++i];
+        bool ok = true;
+        if (opt == "--speeds") ok = parseList(val, cfg.speeds, positive);
+        else if (opt == "--rates") ok = parseList(val, cfg.rates, positive);
+        else if (opt == "--printers") ok = parseList(val, cfg.printers, count);
+        else if (opt == "--disciplines") ok = parseList(val, cfg.disciplines, parseDiscipline);
+        else if (opt == "--policy") ok = parsePolicy(val, cfg.policy);
+        else if (opt == "--aging") cfg.agingRate = std::atof(val.c_str());
+        else if (opt == "--preempt") ok = parseSwitch(val, cfg.preempt);
+        else if (opt == "--split") ok = (cfg.splitPages = std::atoi(val.c_str())) >= 0;
+        else if (opt == "--admission") ok = parseAdmission(val, cfg.admission);
+        else if (opt == "--queue-limit") ok = (cfg.queueLimit = std::atoi(val.c_str())) >= 0;
+        else if (opt == "--reps") ok = (cfg.replications = std::atoi(val.c_str())) > 0;
+        else if (opt == "--threads") ok = (sweep.threads = (unsigned)std::atoi(val.c_str())) > 0;
+        else if (opt == "--out") outPath = val;
+        else {
+            std::fprintf(stderr, "未知选项 %s\n", opt.c_str());
+            usage(argv[0]);
+            return 1;
+        }
+        if (!ok) {
+            std::fprintf(stderr, "选项 %s 的参数无效: %s\n", opt.c_str(), val.c_str());
+            return 1;
+        }
+    }
+
+    std::ofstream file;
+    if (!outPath.empty()) {
+        file.open(outPath, std::ios::trunc);
+        if (!file) {
+            std::fprintf(stderr, "无法写入 %s\n", outPath.c_str());
+            return 1;
+        }
+    }
+    std::ostream& out = outPath.empty() ? std::cout : file;
+
+    sweep.config = cfg;
+    sweep.onProgress = [](size_t done, size_t total) {
+        if (done == total || done % 16 == 0) std::fprintf(stderr, "\r%zu / %zu", done, total);
+    };
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<SweepResult> results = sweep.run();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::fprintf(stderr, "\n用时 %.2f 秒\n", seconds);
+
+    out << "secPerPage,rate,printers,discipline,reps,"
+           "avgWait,avgWaitCI,p95Wait,p95WaitCI,utilisation,utilisationCI,makespan,makespanCI,"
+           "onTimePct,onTimePctCI,rejectedPct,rejectedPctCI\n";
+    for (const auto& r : results) {
+        out << r.point.secPerPage << "," << r.point.rate << "," << r.point.printers << ","
+            << disciplineName(r.point.discipline) << "," << r.avgWait.n << ","
+            << r.avgWait.mean << "," << r.avgWait.half << ","
+            << r.p95Wait.mean << "," << r.p95Wait.half << ","
+            << r.utilisation.mean << "," << r.utilisation.half << ","
+            << r.makespan.mean << "," << r.makespan.half << ","
+            << r.onTimePct.mean << "," << r.onTimePct.half << ","
+            << r.rejectedPct.mean << "," << r.rejectedPct.half << "\n";
+    }
+    return 0;
+}
+
+static volatile std::sig_atomic_t g_stop = 0;
+
+static void onSignal(int)
+{
+    g_stop = 1;
+}
+
+// 常驻服务：引擎在后台线程上运行，IPC 服务端把请求成批交给它
+static int serve(int argc, char *argv[])
+{
+    if (argc < 3) {
+        usage(argv[0]);
+        return 1;
+    }
+    std::string socketPath = argv[2];
+    std::string dataDir = "data";
+    double pace = 0.0;
+    int printerCount = 0;
+    double speed = 0.0;
+    int preempt = -1;   // -1 表示沿用恢复的状态
+    int splitPages = -1;
+    int admission = -1;
+    int queueLimit = -1;
+    int metricsPort = 0;
+    for (int i = 3; i < argc; ++i) {
+        std::string opt = argv[i];
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "选项 %s 缺少参数\n", opt.c_str());
+            return 1;
+        }
+        std::string val = argv[++i];
+        bool ok = true;
+        if (opt == "--data") dataDir = val;
+        else if (opt == "--pace") ok = (pace = std::atof(val.c_str())) >= 0;
+        else if (opt == "--printers") ok = (printerCount = std::atoi(val.c_str())) > 0;
+        else if (opt == "--speed") ok = (speed = std::atof(val.c_str())) > 0;
+        else if (opt == "--preempt") {
+            bool on = false;
+            ok = parseSwitch(val, on);
+            preempt = on ? 1 : 0;
+        }
+        else if (opt == "--split") ok = (splitPages = std::atoi(val.c_str())) >= 0;
+        else if (opt == "--admission") {
+            AdmissionPolicy a = AdmissionPolicy::Off;
+            ok = parseAdmission(val, a);
+            admission = (int)a;
+        }
+        else if (opt == "--queue-limit") ok = (queueLimit = std::atoi(val.c_str())) >= 0;
+        else if (opt == "--metrics-port") ok = (metricsPort = std::atoi(val.c_str())) > 0 && metricsPort < 65536;
+        else {
+            std::fprintf(stderr, "未知选项 %s\n", opt.c_str());
+            usage(argv[0]);
+            return 1;
+        }
+        if (!ok) {
+            std::fprintf(stderr, "选项 %s 的参数无效: %s\n", opt.c_str(), val.c_str());
+            return 1;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(dataDir, ec);
+    SimWorker worker;
+    worker.start([&](PrintManager& pm) {
+        pm.setDataDir(dataDir);
+        pm.load();
+        if (printerCount > 0) pm.setPrinterCount(printerCount);
+        if (speed > 0) pm.setSpeed(speed);
+        if (preempt >= 0) pm.setPreemption(preempt == 1);
+        if (splitPages >= 0) pm.setSplitPages(splitPages);
+        if (admission >= 0 || queueLimit >= 0)
+            pm.setAdmission(admission >= 0 ? (AdmissionPolicy)admission : pm.admission,
+                            queueLimit >= 0 ? queueLimit : pm.queueLimit);
+        pm.saveAll();
+    });
+
+    IpcServer server;
+    if (!server.start(socketPath, [&worker](IpcServer::Command c) { worker.post(std::move(c)); })) {
+        std::fprintf(stderr, "无法在 %s 上监听\n", socketPath.c_str());
+        worker.stop();
+        return 1;
+    }
+    MetricsServer metricsServer;
+    if (metricsPort > 0 && kMetricsEnabled &&
+        !metricsServer.start(metricsPort, [] { return Metrics::global().prometheus(); })) {
+        std::fprintf(stderr, "无法在 127.0.0.1:%d 上监听\n", metricsPort);
+    }
+    if (pace > 0) worker.setPace(pace);
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    std::fprintf(stderr, "正在 %s 上接受请求（数据目录 %s），Ctrl+C 退出\n", socketPath.c_str(), dataDir.c_str());
+
+    while (!g_stop) std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    server.stop();
+    worker.post([](PrintManager& pm) { pm.saveAll(); });
+    worker.stop();
+    std::fprintf(stderr, "已处理 %llu 个请求\n", server.requests());
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 || !std::strcmp(argv[1], "-h") || !std::strcmp(argv[1], "--help")) {
+        usage(argv[0]);
+        return argc < 2 ? 1 : 0;
+    }
+    if (!std::strcmp(argv[1], "--export")) return exportDone(argc, argv);
+    if (!std::strcmp(argv[1], "--sweep")) return runSweep(argc, argv);
+    if (!std::strcmp(argv[1], "--serve")) return serve(argc, argv);
+
+    std::string tracePath;
+    std::string workload;
+    int firstOpt = 2;
+    if (!std::strcmp(argv[1], "--generate")) {
+        if (argc < 3) {
+            usage(argv[0]);
+            return 1;
+        }
+        workload = argv[2];
+        firstOpt = 3;
+    } else {
+        tracePath = argv[1];
+    }
+    std::string donePath = "done_out.csv";
+    std::string summaryPath;
+    std::string traceOut;
+    std::string metricsOut;
+    int metricsPort = 0;
+    int printerCount = 1;
+    double speed = 2.0;
+    double aging = 0.01;
+    DispatchPolicy policy = DispatchPolicy::Fifo;
+    QueueDiscipline discipline = QueueDiscipline::Fifo;
+    bool preempt = false;
+    int splitPages = 0;
+    AdmissionPolicy admission = AdmissionPolicy::Off;
+    int queueLimit = 0;
+
+    for (int i = firstOpt; i < argc; ++i) {
+        std::string opt = argv[i];
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "选项 %s 缺少参数\n", opt.c_str());
+            return 1;
+        }
+        std::string val = argv[++i];
+        bool ok = true;
+        if (opt == "--printers") ok = (printerCount = std::atoi(val.c_str())) > 0;
+        else if (opt == "--speed") ok = (speed = std::atof(val.c_str())) > 0;
+        else if (opt == "--aging") aging = std::atof(val.c_str());
+        else if (opt == "--policy") ok = parsePolicy(val, policy);
+        else if (opt == "--discipline") ok = parseDiscipline(val, discipline);
+        else if (opt == "--preempt") ok = parseSwitch(val, preempt);
+        else if (opt == "--split") ok = (splitPages = std::atoi(val.c_str())) >= 0;
+        else if (opt == "--admission") ok = parseAdmission(val, admission);
+        else if (opt == "--queue-limit") ok = (queueLimit = std::atoi(val.c_str())) >= 0;
+        else if (opt == "--done") donePath = val;
+        else if (opt == "--summary") summaryPath = val;
+        else if (opt == "--trace-out" && !workload.empty()) traceOut = val;
+        else if (opt == "--metrics-out") metricsOut = val;
+        else if (opt == "--metrics-port") ok = (metricsPort = std::atoi(val.c_str())) > 0 && metricsPort < 65536;
+        else {
+            std::fprintf(stderr, "未知选项 %s\n", opt.c_str());
+            usage(argv[0]);
+            return 1;
+        }
+        if (!ok) {
+            std::fprintf(stderr, "选项 %s 的参数无效: %s\n", opt.c_str(), val.c_str());
+            return 1;
+        }
+    }
+
+    // 不写 data/ 下的快照和日志，只在结束时输出结果
+    PrintManager pm;
+    pm.persist = false;
+    pm.done.maxJobs = 0;   // 没有 done.bin 可以转存，完成记录全部留在内存里供最后导出
+    pm.setSpeed(speed);
+    pm.setPrinterCount(printerCount);
+    pm.setPolicy(policy);
+    pm.setDiscipline(discipline, aging);
+    pm.setPreemption(preempt);
+    pm.setSplitPages(splitPages);
+    pm.setAdmission(admission, queueLimit);
+
+    MetricsServer metricsServer;
+    if (metricsPort > 0) {
+        if (!kMetricsEnabled)
+            std::fprintf(stderr, "未启用运行时指标（PRINTMANAGER_METRICS=0），忽略 --metrics-port\n");
+        else if (!metricsServer.start(metricsPort, [] { return Metrics::global().prometheus(); }))
+            std::fprintf(stderr, "无法在 127.0.0.1:%d 上监听\n", metricsPort);
+    }
+    // 分段跑完：每段结束时刷新一次指标，抓取方看到的是运行中的数值
+    auto runAll = [&pm]() {
+        while (!pm.runFor(65536)) {
+        }
+    };
+
+    auto t0 = std::chrono::steady_clock::now();
+    long long jobs = 0;
+    if (workload.empty()) {
+        jobs = loadTrace(pm, tracePath);
+        if (jobs < 0) {
+            std::fprintf(stderr, "无法打开轨迹文件 %s\n", tracePath.c_str());
+            return 1;
+        }
+        runAll();
+    } else {
+        WorkloadSpec spec;
+        std::string err;
+        if (!WorkloadSpec::parse(workload, spec, &err)) {
+            std::fprintf(stderr, "工作负载规格无效: %s\n", err.c_str());
+            return 1;
+        }
+        if (spec.jobs == 0) {
+            std::fprintf(stderr, "命令行模式需要有限的任务数（jobs=N）\n");
+            return 1;
+        }
+        std::ofstream trace;
+        if (!traceOut.empty()) {
+            trace.open(traceOut, std::ios::trunc);
+            if (!trace) {
+                std::fprintf(stderr, "无法写入 %s\n", traceOut.c_str());
+                return 1;
+            }
+            trace << "user,doc,pages,submitTime,priority,deadline\n";
+        }
+        WorkloadGenerator gen(spec);
+        pm.setSource([&gen, &trace](JobSpec& s) {
+            if (!gen.next(s)) return false;
+            if (trace.is_open()) {
+                StringPool& strings = StringPool::global();
+                trace << csvEscape(strings.user(s.user)) << "," << csvEscape(strings.doc(s.doc)) << ","
+                      << s.pages << "," << timeText(s.submitTime) << "," << s.priority << ","
+                      << timeText(s.deadline) << "\n";
+            }
+            return true;
+        });
+        runAll();
+        jobs = gen.produced();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    pm.fileDone = donePath;
+    pm.saveDone();
+
+    if (summaryPath.empty()) {
+        writeSummary(std::cout, pm, jobs, seconds);
+    } else {
+        std::ofstream out(summaryPath, std::ios::trunc);
+        if (!out) {
+            std::fprintf(stderr, "无法写入 %s\n", summaryPath.c_str());
+            return 1;
+        }
+        writeSummary(out, pm, jobs, seconds);
+    }
+    if (!metricsOut.empty() && !Metrics::global().dump(metricsOut)) {
+        std::fprintf(stderr, "无法写入 %s\n", metricsOut.c_str());
+        return 1;
+    }
+    return 0;
+}
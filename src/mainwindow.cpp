@@ -2,27 +2,78 @@
 #include <QHeaderView>
 #include <QMessageBox>
 #include <QInputDialog>
-#include <random>
 #include <ctime>
+#include <cstdlib>
+
+static const size_t kDoneQueryLimit = 10000;   // 查询结果最多显示的条数
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
 {
-    pm.saveAll();
+    // 后台线程的回调只负责把工作转交给界面线程；连续的发布合并成一次刷新，
+    // 刷新频率不超过 frameIntervalMs，与引擎推进的步频无关
+    worker.onPublish = [this]() {
+        if (!refreshQueued.exchange(true)) {
+            onGui([this]() {
+                refreshQueued = false;
+                scheduleFrame();
+            });
+        }
+    };
+    worker.onRunFinished = [this](bool completed) {
+        onGui([this, completed]() {
+            QMessageBox::information(this, "完成", completed ? "所有任务已完成！" : "已中止运行");
+        });
+    };
+    // 在后台线程上从上次的快照和日志恢复队列，再压缩成新的快照
+    worker.start([](PrintManager& pm) {
+        pm.load();
+        pm.saveAll();
+    });
     setupUI();
+    snap = worker.snapshot();
+    speedSpinBox->setValue(snap->secPerPage);
+    printerCountSpinBox->setValue(snap->printers.size());
+    policyCombo->setCurrentIndex(policyCombo->findData((int)snap->policy));
+    disciplineCombo->setCurrentIndex(disciplineCombo->findData((int)snap->discipline));
+    preemptCheck->setChecked(snap->preempt);
+    splitSpinBox->setValue(snap->splitPages);
+    admissionCombo->setCurrentIndex(admissionCombo->findData((int)snap->admission));
+    queueLimitSpinBox->setValue(snap->queueLimit);
+    // 只在有新快照时刷新（由 onPublish 触发）；日志落盘由后台线程负责
+    frameTimer = new QTimer(this);
+    frameTimer->setSingleShot(true);
+    connect(frameTimer, &QTimer::timeout, this, &MainWindow::updateDisplay);
     updateDisplay();
-    
-    // 设置自动刷新定时器（每秒更新一次显示）
-    autoTimer = new QTimer(this);
-    connect(autoTimer, &QTimer::timeout, this, &MainWindow::updateDisplay);
-    autoTimer->start(1000); // 每秒更新
-    
-    // 初始化自动推进定时器
-    autoTickTimer = nullptr;
+
+    // 可选的本机指标端点：PRINTMANAGER_METRICS_PORT=9464 时抓取 http://127.0.0.1:9464/metrics
+    if (const char *port = std::getenv("PRINTMANAGER_METRICS_PORT")) {
+        int p = std::atoi(port);
+        if (kMetricsEnabled && p > 0 && p < 65536 &&
+            !metricsServer.start(p, [] { return Metrics::global().prometheus(); })) {
+            QMessageBox::warning(this, "性能指标", QString("无法在 127.0.0.1:%1 上监听").arg(p));
+        }
+    }
+
+    // 可选的本机提交接口（协议见 ipc.h）：请求在 I/O 线程上解析后成批交给引擎线程，不经过界面线程
+    if (const char *sock = std::getenv("PRINTMANAGER_IPC_SOCKET")) {
+        if (!ipcServer.start(sock, [this](IpcServer::Command c) { worker.post(std::move(c)); })) {
+            QMessageBox::warning(this, "提交接口", QString("无法在 %1 上监听").arg(QString::fromUtf8(sock)));
+        }
+    }
 }
 
 MainWindow::~MainWindow()
 {
+    // 先停止接受外部请求；退出前在后台线程上做一次完整快照（日志随之截断），再结束线程
+    ipcServer.stop();
+    worker.post([](PrintManager& pm) { pm.saveAll(); });
+    worker.stop();
+}
+
+void MainWindow::onGui(std::function<void()> fn)
+{
+    QMetaObject::invokeMethod(this, std::move(fn), Qt::QueuedConnection);
 }
 
 void MainWindow::setupUI()
@@ -75,6 +126,65 @@ void MainWindow::setupUI()
     
     controlLayout->addSpacing(20);
     
+    // 打印机数量与调度策略
+    controlLayout->addWidget(new QLabel("打印机数:", this));
+    printerCountSpinBox = new QSpinBox(this);
+    printerCountSpinBox->setRange(1, 64);
+    printerCountSpinBox->setValue(1);
+    controlLayout->addWidget(printerCountSpinBox);
+    
+    policyCombo = new QComboBox(this);
+    policyCombo->addItem("先来先服务", (int)DispatchPolicy::Fifo);
+    policyCombo->addItem("短作业优先", (int)DispatchPolicy::ShortestJobFirst);
+    policyCombo->addItem("负载最小", (int)DispatchPolicy::LeastLoaded);
+    policyCombo->addItem("用户公平", (int)DispatchPolicy::FairShare);
+    controlLayout->addWidget(policyCombo);
+    
+    disciplineCombo = new QComboBox(this);
+    disciplineCombo->addItem("到达顺序", (int)QueueDiscipline::Fifo);
+    disciplineCombo->addItem("优先级", (int)QueueDiscipline::Priority);
+    disciplineCombo->addItem("最短作业", (int)QueueDiscipline::ShortestJob);
+    disciplineCombo->addItem("最短剩余", (int)QueueDiscipline::ShortestRemaining);
+    disciplineCombo->addItem("老化优先级", (int)QueueDiscipline::AgingPriority);
+    controlLayout->addWidget(disciplineCombo);
+
+    // 抢占：排在前面的任务到达后，正在打印的任务打完当前页即让出打印机（用户公平策略下不抢占）
+    preemptCheck = new QCheckBox("抢占", this);
+    connect(preemptCheck, &QCheckBox::clicked, this, [this](bool on) {
+        worker.post([on](PrintManager& pm) { pm.setPreemption(on); });
+    });
+    controlLayout->addWidget(preemptCheck);
+
+    // 拆分阈值：超过该页数的新任务按页码区间拆成几段，同时在多台打印机上打印（随“应用”生效）
+    controlLayout->addWidget(new QLabel("拆分阈值:", this));
+    splitSpinBox = new QSpinBox(this);
+    splitSpinBox->setRange(0, 100000);
+    splitSpinBox->setSpecialValueText("不拆分");
+    controlLayout->addWidget(splitSpinBox);
+
+    // 准入控制：预计赶不上截止时刻的任务拒绝或降级；队列达到上限时拒绝新提交（随“应用”生效）
+    admissionCombo = new QComboBox(this);
+    admissionCombo->addItem("不检查截止", (int)AdmissionPolicy::Off);
+    admissionCombo->addItem("超时拒绝", (int)AdmissionPolicy::Reject);
+    admissionCombo->addItem("超时降级", (int)AdmissionPolicy::Demote);
+    controlLayout->addWidget(admissionCombo);
+
+    controlLayout->addWidget(new QLabel("队列上限:", this));
+    queueLimitSpinBox = new QSpinBox(this);
+    queueLimitSpinBox->setRange(0, 1000000);
+    queueLimitSpinBox->setSpecialValueText("不限");
+    controlLayout->addWidget(queueLimitSpinBox);
+    
+    setPrintersBtn = new QPushButton("应用", this);
+    connect(setPrintersBtn, &QPushButton::clicked, this, &MainWindow::onSetPrinters);
+    controlLayout->addWidget(setPrintersBtn);
+    
+    compareBtn = new QPushButton("比较排队规则", this);
+    connect(compareBtn, &QPushButton::clicked, this, &MainWindow::onCompareDisciplines);
+    controlLayout->addWidget(compareBtn);
+    
+    controlLayout->addSpacing(20);
+    
     // 模拟推进
     controlLayout->addWidget(new QLabel("推进秒数:", this));
     tickSecondsSpinBox = new QSpinBox(this);
@@ -90,26 +200,22 @@ void MainWindow::setupUI()
     connect(runToEndBtn, &QPushButton::clicked, this, &MainWindow::onRunToEnd);
     controlLayout->addWidget(runToEndBtn);
     
+    // 实时模式：后台线程按墙钟 × 倍速推进仿真时钟
+    controlLayout->addWidget(new QLabel("倍速:", this));
+    paceSpinBox = new QSpinBox(this);
+    paceSpinBox->setRange(1, 10000);
+    paceSpinBox->setValue(1);
+    paceSpinBox->setSuffix("×");
+    connect(paceSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int v) {
+        if (autoTickBtn->isChecked()) worker.setPace(v);
+    });
+    controlLayout->addWidget(paceSpinBox);
+
     autoTickBtn = new QPushButton("自动推进", this);
     autoTickBtn->setCheckable(true);
     connect(autoTickBtn, &QPushButton::toggled, this, [this](bool checked) {
-        if (checked) {
-            autoTickBtn->setText("停止自动");
-            // 每秒自动推进1秒
-            if (!autoTickTimer) {
-                autoTickTimer = new QTimer(this);
-                connect(autoTickTimer, &QTimer::timeout, this, [this]() {
-                    pm.tick(1);
-                    updateDisplay();
-                });
-            }
-            autoTickTimer->start(1000);
-        } else {
-            autoTickBtn->setText("自动推进");
-            if (autoTickTimer) {
-                autoTickTimer->stop();
-            }
-        }
+        autoTickBtn->setText(checked ? "停止自动" : "自动推进");
+        worker.setPace(checked ? paceSpinBox->value() : 0);
     });
     controlLayout->addWidget(autoTickBtn);
     
@@ -137,6 +243,19 @@ void MainWindow::setupUI()
     pagesSpinBox->setValue(10);
     addJobLayout->addWidget(pagesSpinBox);
     
+    addJobLayout->addWidget(new QLabel("优先级:", this));
+    prioritySpinBox = new QSpinBox(this);
+    prioritySpinBox->setRange(0, 9);
+    prioritySpinBox->setValue(0);
+    addJobLayout->addWidget(prioritySpinBox);
+
+    addJobLayout->addWidget(new QLabel("截止:", this));
+    deadlineSpinBox = new QSpinBox(this);
+    deadlineSpinBox->setRange(0, 7 * 24 * 3600);
+    deadlineSpinBox->setSuffix(" 秒后");
+    deadlineSpinBox->setSpecialValueText("无");
+    addJobLayout->addWidget(deadlineSpinBox);
+    
     addJobBtn = new QPushButton("添加任务", this);
     connect(addJobBtn, &QPushButton::clicked, this, &MainWindow::onAddJob);
     addJobLayout->addWidget(addJobBtn);
@@ -148,17 +267,35 @@ void MainWindow::setupUI()
     mainLayout->addWidget(addJobGroup);
     
     // ========== 取消任务区域 ==========
-    cancelJobGroup = new QGroupBox("取消任务", this);
+    cancelJobGroup = new QGroupBox("取消 / 暂停任务", this);
     QHBoxLayout *cancelLayout = new QHBoxLayout(cancelJobGroup);
     
     cancelLayout->addWidget(new QLabel("任务ID:", this));
     cancelIdSpinBox = new QSpinBox(this);
-    cancelIdSpinBox->setRange(1, 100000);
+    cancelIdSpinBox->setRange(1, 1000000000);
     cancelLayout->addWidget(cancelIdSpinBox);
     
     cancelJobBtn = new QPushButton("取消任务", this);
     connect(cancelJobBtn, &QPushButton::clicked, this, &MainWindow::onCancelJob);
     cancelLayout->addWidget(cancelJobBtn);
+
+    pauseJobBtn = new QPushButton("暂停", this);
+    connect(pauseJobBtn, &QPushButton::clicked, this, &MainWindow::onPauseJob);
+    cancelLayout->addWidget(pauseJobBtn);
+
+    resumeJobBtn = new QPushButton("恢复", this);
+    connect(resumeJobBtn, &QPushButton::clicked, this, &MainWindow::onResumeJob);
+    cancelLayout->addWidget(resumeJobBtn);
+    
+    cancelLayout->addSpacing(20);
+    cancelLayout->addWidget(new QLabel("用户:", this));
+    cancelUserEdit = new QLineEdit(this);
+    cancelUserEdit->setPlaceholderText("取消该用户的全部等待任务");
+    cancelLayout->addWidget(cancelUserEdit);
+    
+    cancelUserBtn = new QPushButton("按用户取消", this);
+    connect(cancelUserBtn, &QPushButton::clicked, this, &MainWindow::onCancelUserJobs);
+    cancelLayout->addWidget(cancelUserBtn);
     
     cancelLayout->addStretch();
     
@@ -173,10 +310,9 @@ void MainWindow::setupUI()
     // 等待队列表格
     waitingGroup = new QGroupBox("等待队列", this);
     QVBoxLayout *waitingLayout = new QVBoxLayout(waitingGroup);
-    waitingTable = new QTableWidget(this);
-    waitingTable->setColumnCount(5);
-    QStringList waitingHeaders = {"ID", "用户", "文档名", "页数", "提交时间"};
-    waitingTable->setHorizontalHeaderLabels(waitingHeaders);
+    waitingTable = new QTableView(this);
+    waitingModel = new WaitingTableModel(this);
+    waitingTable->setModel(waitingModel);
     waitingTable->horizontalHeader()->setStretchLastSection(true);
     waitingTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     waitingTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
@@ -200,10 +336,33 @@ void MainWindow::setupUI()
     // 已完成任务表格
     doneGroup = new QGroupBox("已完成任务", this);
     QVBoxLayout *doneLayout = new QVBoxLayout(doneGroup);
-    doneTable = new QTableWidget(this);
-    doneTable->setColumnCount(8);
-    QStringList doneHeaders = {"ID", "用户", "文档名", "页数", "提交时间", "开始时间", "结束时间", "等待/耗时(秒)"};
-    doneTable->setHorizontalHeaderLabels(doneHeaders);
+
+    // 查询：较早的记录已不在表格中，按 ID/用户/完成时间从完成日志里查
+    QHBoxLayout *doneQueryLayout = new QHBoxLayout();
+    doneQueryCombo = new QComboBox(this);
+    doneQueryCombo->addItem("按ID");
+    doneQueryCombo->addItem("按用户");
+    doneQueryCombo->addItem("按完成时间");
+    doneQueryLayout->addWidget(doneQueryCombo);
+    doneQueryEdit = new QLineEdit(this);
+    doneQueryEdit->setPlaceholderText("任务ID / 用户名 / 起始秒-结束秒");
+    connect(doneQueryEdit, &QLineEdit::returnPressed, this, &MainWindow::onQueryDone);
+    doneQueryLayout->addWidget(doneQueryEdit);
+    doneQueryBtn = new QPushButton("查询", this);
+    connect(doneQueryBtn, &QPushButton::clicked, this, &MainWindow::onQueryDone);
+    doneQueryLayout->addWidget(doneQueryBtn);
+    doneLatestBtn = new QPushButton("最近记录", this);
+    connect(doneLatestBtn, &QPushButton::clicked, this, &MainWindow::onShowLatestDone);
+    doneQueryLayout->addWidget(doneLatestBtn);
+    doneExportBtn = new QPushButton("导出CSV", this);
+    connect(doneExportBtn, &QPushButton::clicked, this, &MainWindow::onExportDone);
+    doneQueryLayout->addWidget(doneExportBtn);
+    doneLayout->addLayout(doneQueryLayout);
+
+    doneTable = new QTableView(this);
+    doneModel = new DoneTableModel(doneJobs, this);
+    queryModel = new DoneTableModel(queryJobs, this);
+    doneTable->setModel(doneModel);
     doneTable->horizontalHeader()->setStretchLastSection(true);
     doneTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     doneTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
@@ -215,9 +374,22 @@ void MainWindow::setupUI()
     QVBoxLayout *statsLayout = new QVBoxLayout(statsGroup);
     statsText = new QTextEdit(this);
     statsText->setReadOnly(true);
-    statsText->setMaximumHeight(100);
+    statsText->setMaximumHeight(180);
     statsLayout->addWidget(statsText);
     rightLayout->addWidget(statsGroup);
+
+    // 性能指标（编译时关闭 PRINTMANAGER_METRICS 则只显示提示）
+    metricsGroup = new QGroupBox("性能指标", this);
+    QVBoxLayout *metricsLayout = new QVBoxLayout(metricsGroup);
+    metricsText = new QTextEdit(this);
+    metricsText->setReadOnly(true);
+    metricsText->setMaximumHeight(130);
+    metricsLayout->addWidget(metricsText);
+    metricsDumpBtn = new QPushButton("导出指标", this);
+    metricsDumpBtn->setEnabled(kMetricsEnabled);
+    connect(metricsDumpBtn, &QPushButton::clicked, this, &MainWindow::onDumpMetrics);
+    metricsLayout->addWidget(metricsDumpBtn);
+    rightLayout->addWidget(metricsGroup);
     
     contentLayout->addLayout(rightLayout, 1);
     
@@ -239,76 +411,202 @@ void MainWindow::onAddJob()
         return;
     }
     
-    int id = pm.addJob(user.toStdString(), doc.toStdString(), pages);
-    QMessageBox::information(this, "成功", 
-        QString("任务已添加！\nID: %1\n当前时间: %2")
-        .arg(id).arg(QString::fromStdString(PrintManager::fmt(pm.currentTime))));
+    int priority = prioritySpinBox->value();
+    int deadline = deadlineSpinBox->value();
+    worker.post([this, u = user.toStdString(), d = doc.toStdString(), pages, priority, deadline](PrintManager& pm) {
+        int id = pm.addJob(u, d, pages, priority, deadline > 0 ? pm.currentTime + secToTime(deadline) : -1);
+        SimTime now = pm.currentTime;
+        onGui([this, id, now]() {
+            if (id == 0) {
+                QMessageBox::warning(this, "被拒绝", "任务未被接受：等待队列已满，或预计无法在截止时刻前完成");
+                return;
+            }
+            QMessageBox::information(this, "成功", 
+                QString("任务已添加！\nID: %1\n当前时间: %2")
+                .arg(id).arg(QString::fromStdString(PrintManager::fmt(now))));
+        });
+    });
     
     userEdit->clear();
     docEdit->clear();
     pagesSpinBox->setValue(10);
-    updateDisplay();
+    prioritySpinBox->setValue(0);
+    deadlineSpinBox->setValue(0);
 }
 
 void MainWindow::onCancelJob()
 {
     int id = cancelIdSpinBox->value();
-    bool ok = pm.cancelJob(id);
-    if (ok) {
-        QMessageBox::information(this, "成功", QString("任务 #%1 已取消").arg(id));
-    } else {
-        QMessageBox::warning(this, "失败", QString("未找到任务 #%1（可能不在等待队列中）").arg(id));
+    worker.post([this, id](PrintManager& pm) {
+        bool ok = pm.cancelJob(id);
+        onGui([this, id, ok]() {
+            if (ok) {
+                QMessageBox::information(this, "成功", QString("任务 #%1 已取消").arg(id));
+            } else {
+                QMessageBox::warning(this, "失败", QString("未找到任务 #%1（可能已完成或尚未到达）").arg(id));
+            }
+        });
+    });
+}
+
+void MainWindow::onPauseJob()
+{
+    // 正在打印的任务立即让出打印机，已打完的页保留
+    int id = cancelIdSpinBox->value();
+    worker.post([this, id](PrintManager& pm) {
+        bool ok = pm.pauseJob(id);
+        onGui([this, id, ok]() {
+            if (!ok) QMessageBox::warning(this, "失败", QString("任务 #%1 不在等待队列中，也不在打印").arg(id));
+        });
+    });
+}
+
+void MainWindow::onResumeJob()
+{
+    int id = cancelIdSpinBox->value();
+    worker.post([this, id](PrintManager& pm) {
+        bool ok = pm.resumeJob(id);
+        onGui([this, id, ok]() {
+            if (!ok) QMessageBox::warning(this, "失败", QString("任务 #%1 没有被暂停").arg(id));
+        });
+    });
+}
+
+void MainWindow::onCancelUserJobs()
+{
+    QString user = cancelUserEdit->text().trimmed();
+    if (user.isEmpty()) {
+        QMessageBox::warning(this, "输入错误", "请输入用户名！");
+        return;
     }
-    updateDisplay();
+    // 一次扫描等待队列、日志只同步一次
+    worker.post([this, u = user.toStdString()](PrintManager& pm) {
+        size_t n = pm.cancelUserJobs(u);
+        onGui([this, u, n]() {
+            QMessageBox::information(this, "按用户取消",
+                QString("已取消用户 %1 的 %2 个等待任务").arg(QString::fromStdString(u)).arg((qulonglong)n));
+        });
+    });
+    cancelUserEdit->clear();
 }
 
 void MainWindow::onSetSpeed()
 {
     double speed = speedSpinBox->value();
-    pm.setSpeed(speed);
+    worker.post([speed](PrintManager& pm) { pm.setSpeed(speed); });
     QMessageBox::information(this, "成功", 
         QString("打印速度已设置为 %1 秒/页").arg(speed, 0, 'f', 3));
-    updateDisplay();
+}
+
+void MainWindow::onSetPrinters()
+{
+    int wanted = printerCountSpinBox->value();
+    auto policy = (DispatchPolicy)policyCombo->currentData().toInt();
+    auto discipline = (QueueDiscipline)disciplineCombo->currentData().toInt();
+    int split = splitSpinBox->value();
+    auto admission = (AdmissionPolicy)admissionCombo->currentData().toInt();
+    int limit = queueLimitSpinBox->value();
+    worker.post([this, wanted, policy, discipline, split, admission, limit](PrintManager& pm) {
+        int n = pm.setPrinterCount(wanted);
+        pm.setPolicy(policy);
+        pm.setDiscipline(discipline);
+        if (split != pm.splitPages) pm.setSplitPages(split);
+        if (admission != pm.admission || limit != pm.queueLimit) pm.setAdmission(admission, limit);
+        if (n == wanted) return;
+        onGui([this, n]() {
+            QMessageBox::warning(this, "提示",
+                QString("正在打印的打印机不能移除，当前共 %1 台").arg(n));
+            printerCountSpinBox->setValue(n);
+        });
+    });
+}
+
+void MainWindow::onCompareDisciplines()
+{
+    // 以当前等待队列为工作负载，在独立实例上分别用每种规则跑完。
+    // 在后台线程上取队列并运行（期间仿真暂停处理其它命令），结果交回界面线程显示，窗口不会卡住
+    compareBtn->setEnabled(false);
+    worker.post([this](PrintManager& pm) {
+        std::vector<JobSpec> workload;
+        workload.reserve(pm.waitQ.size());
+        for (const auto& j : pm.waitQ) {
+            JobSpec s;
+            s.user = j.user;
+            s.doc = j.doc;
+            s.pages = j.pages;
+            s.submitTime = j.submitTime;
+            s.priority = j.priority;
+            s.deadline = j.deadline;
+            workload.push_back(s);
+        }
+        std::vector<std::pair<QueueDiscipline, PrintManager::Statistics>> results;
+        if (!workload.empty())
+            results = PrintManager::compareDisciplines(workload, (int)pm.printers.size(), pm.secPerPage, pm.agingRate);
+        onGui([this, n = workload.size(), results = std::move(results)]() {
+            compareBtn->setEnabled(true);
+            if (n == 0) {
+                QMessageBox::information(this, "比较排队规则", "等待队列为空，请先添加任务");
+                return;
+            }
+            QString text = QString("以当前 %1 个等待任务模拟：\n").arg(n);
+            for (const auto& r : results) {
+                int idx = disciplineCombo->findData((int)r.first);
+                text += QString("\n%1: 平均等待 %2 秒，平均耗时 %3 秒")
+                    .arg(disciplineCombo->itemText(idx))
+                    .arg(r.second.avgWaitTime, 0, 'f', 2)
+                    .arg(r.second.avgDuration, 0, 'f', 2);
+                if (r.second.deadlineJobs > 0)
+                    text += QString("，按时完成 %1%").arg(r.second.onTimePct, 0, 'f', 1);
+            }
+            QMessageBox::information(this, "比较排队规则", text);
+        });
+    });
 }
 
 void MainWindow::onTick()
 {
     int dt = tickSecondsSpinBox->value();
-    pm.tick(dt);
-    updateDisplay();
+    worker.post([dt](PrintManager& pm) { pm.tick(dt); });
 }
 
 void MainWindow::onRunToEnd()
 {
-    pm.runToEnd();
-    QMessageBox::information(this, "完成", "所有任务已完成！");
-    updateDisplay();
+    // 在后台分段运行，运行期间再次点击则中止；结束时由 onRunFinished 提示
+    if (snap && snap->running) {
+        worker.cancelRun();
+    } else {
+        worker.runToEnd();
+    }
 }
 
 void MainWindow::onRandomJobs()
 {
+    // 按工作负载规格（格式见 workload.h）在后台逐个生成任务，任务在各自的到达时刻进入队列
+    if (lastWorkload.isEmpty()) {
+        lastWorkload = QString("seed=%1,jobs=100,rate=0.5,users=10,pages=uniform:1:10")
+            .arg((unsigned long long)time(nullptr));
+    }
     bool ok;
-    int count = QInputDialog::getInt(this, "随机生成任务", "任务数量:", 5, 1, 100, 1, &ok);
-    if (!ok) return;
-    
-    int minPages = QInputDialog::getInt(this, "随机生成任务", "最小页数:", 1, 1, 1000, 1, &ok);
-    if (!ok) return;
-    
-    int maxPages = QInputDialog::getInt(this, "随机生成任务", "最大页数:", 10, minPages, 1000, 1, &ok);
+    QString text = QInputDialog::getText(this, "随机生成任务",
+        "工作负载规格（arrival=poisson|mmpp, rate, burst, users, zipf, pages=uniform|pareto|lognormal:a:b, max, prio）:",
+        QLineEdit::Normal, lastWorkload, &ok);
     if (!ok) return;
-    
-    std::mt19937 rng((unsigned)time(nullptr));
-    std::uniform_int_distribution<int> pagesDist(minPages, maxPages);
-    
-    for (int i = 1; i <= count; ++i) {
-        std::string user = "User" + std::to_string(i);
-        std::string doc = "Doc" + std::to_string(i);
-        int p = pagesDist(rng);
-        pm.addJob(user, doc, p);
+
+    WorkloadSpec spec;
+    std::string err;
+    if (!WorkloadSpec::parse(text.trimmed().toStdString(), spec, &err)) {
+        QMessageBox::warning(this, "输入错误", QString::fromStdString("工作负载规格无效: " + err));
+        return;
     }
-    
-    QMessageBox::information(this, "成功", QString("已生成 %1 个随机任务").arg(count));
-    updateDisplay();
+    lastWorkload = text.trimmed();
+    worker.post([spec](PrintManager& pm) mutable {
+        spec.startTime += pm.currentTime;   // 从当前仿真时刻起到达
+        auto gen = std::make_shared<WorkloadGenerator>(spec);
+        pm.setSource([gen](JobSpec& s) { return gen->next(s); });
+    });
+
+    QString count = spec.jobs > 0 ? QString::number(spec.jobs) : QString("不限数量的");
+    QMessageBox::information(this, "成功", QString("已开始按到达时刻生成 %1 个任务").arg(count));
 }
 
 void MainWindow::onAutoTick()
@@ -316,34 +614,66 @@ void MainWindow::onAutoTick()
     // 已在setupUI中实现
 }
 
+// 距上次刷新不足一帧时推迟到下一帧；已有一帧在等待时什么也不做，届时读取最新的快照
+void MainWindow::scheduleFrame()
+{
+    if (frameTimer->isActive()) return;
+    qint64 since = frameClock.isValid() ? frameClock.elapsed() : frameIntervalMs;
+    frameTimer->start(since >= frameIntervalMs ? 0 : int(frameIntervalMs - since));
+}
+
 void MainWindow::updateDisplay()
 {
-    refreshStatus();
-    refreshWaitingTable();
-    refreshRunningInfo();
-    refreshDoneTable();
-    refreshStatistics();
+    // 只读取后台线程发布的快照，不会等待引擎
+    auto s = worker.snapshot();
+    if (!s) return;
+    frameClock.restart();
+    snap = s;
+    {
+        metrics::ScopedTimer timer(kMetricsEnabled ? &Metrics::global().uiRefreshLatency : nullptr);
+        refreshStatus();
+        refreshWaitingTable();
+        refreshRunningInfo();
+        refreshDoneTable();
+        refreshStatistics();
+    }
+    refreshMetrics();
 }
 
 void MainWindow::refreshStatus()
 {
-    timeLabel->setText(QString("当前时间: %1").arg(QString::fromStdString(PrintManager::fmt(pm.currentTime))));
+    QString clock = QString("当前时间: %1").arg(QString::fromStdString(PrintManager::fmt(snap->currentTime)));
+    if (snap->paceSpeedup > 0) {
+        clock += QString("（%1×").arg(snap->paceSpeedup, 0, 'g', 6);
+        if (snap->paceLag > 0) clock += QString("，落后 %1 秒").arg(timeToSec(snap->paceLag), 0, 'f', 1);
+        clock += "）";
+    }
+    timeLabel->setText(clock);
+    runToEndBtn->setText(snap->running ? "中止运行" : "运行至完成");
     
     std::ostringstream ss;
     ss.setf(std::ios::fixed);
-    ss << std::setprecision(3) << pm.secPerPage;
+    ss << std::setprecision(3) << snap->secPerPage;
     speedLabel->setText(QString("打印速度: %1 秒/页").arg(QString::fromStdString(ss.str())));
     
-    if (pm.busy) {
-        printerStatusLabel->setText("打印机状态: 打印中");
+    int busyCount = 0;
+    for (const auto& p : snap->printers) busyCount += p.busy ? 1 : 0;
+    if (busyCount > 0) {
+        printerStatusLabel->setText(QString("打印机状态: %1/%2 台打印中")
+            .arg(busyCount).arg(snap->printers.size()));
         printerStatusLabel->setStyleSheet("font-size: 14px; color: red;");
-        currentJobLabel->setText(QString("任务 #%1 (%2/%3) - 剩余约 %4 秒")
-            .arg(pm.current.id)
-            .arg(QString::fromStdString(pm.current.user))
-            .arg(QString::fromStdString(pm.current.doc))
-            .arg(pm.remainSec));
+        for (const auto& p : snap->printers) {
+            if (!p.busy) continue;
+            currentJobLabel->setText(QString("打印机%1: 任务 #%2 (%3/%4) - 剩余约 %5 秒")
+                .arg(p.id + 1)
+                .arg(p.current.id)
+                .arg(toQString(p.current.userName()))
+                .arg(toQString(p.current.docName()))
+                .arg(timeToSec(p.remain), 0, 'f', 1));
+            break;
+        }
     } else {
-        printerStatusLabel->setText("打印机状态: 空闲");
+        printerStatusLabel->setText(QString("打印机状态: 空闲（共 %1 台）").arg(snap->printers.size()));
         printerStatusLabel->setStyleSheet("font-size: 14px; color: green;");
         currentJobLabel->setText("");
     }
@@ -351,67 +681,220 @@ void MainWindow::refreshStatus()
 
 void MainWindow::refreshWaitingTable()
 {
-    auto jobs = pm.getWaitingJobs();
-    waitingTable->setRowCount(jobs.size());
-    
-    for (size_t i = 0; i < jobs.size(); ++i) {
-        const auto& j = jobs[i];
-        waitingTable->setItem(i, 0, new QTableWidgetItem(QString::number(j.id)));
-        waitingTable->setItem(i, 1, new QTableWidgetItem(QString::fromStdString(j.user)));
-        waitingTable->setItem(i, 2, new QTableWidgetItem(QString::fromStdString(j.doc)));
-        waitingTable->setItem(i, 3, new QTableWidgetItem(QString::number(j.pages)));
-        waitingTable->setItem(i, 4, new QTableWidgetItem(QString::fromStdString(PrintManager::fmt(j.submitTime))));
-    }
+    // 模型只应用增量并把变化的行通知给视图；确认后后台线程丢弃已应用的段
+    worker.ackWaiting(waitingModel->sync(*snap));
 }
 
 void MainWindow::refreshRunningInfo()
 {
-    if (pm.busy) {
-        runningText->setText(QString(
-            "任务ID: %1\n"
-            "用户: %2\n"
-            "文档: %3\n"
-            "页数: %4\n"
-            "开始时间: %5\n"
-            "剩余时间: 约 %6 秒"
-        ).arg(pm.current.id)
-        .arg(QString::fromStdString(pm.current.user))
-        .arg(QString::fromStdString(pm.current.doc))
-        .arg(pm.current.pages)
-        .arg(QString::fromStdString(PrintManager::fmt(pm.current.startTime)))
-        .arg(pm.remainSec));
-    } else {
-        runningText->setText("当前无正在打印的任务");
+    QString text;
+    for (const auto& p : snap->printers) {
+        if (!p.busy) continue;
+        text += QString(
+            "打印机%1（%2 秒/页）: 任务ID %3 | 用户 %4 | 文档 %5 | %6 页 | "
+            "开始 %7 | 已打印 %8 页 | 剩余约 %9 秒\n"
+        ).arg(p.id + 1)
+        .arg(p.secPerPage, 0, 'f', 3)
+        .arg(p.current.id)
+        .arg(toQString(p.current.userName()))
+        .arg(toQString(p.current.docName()))
+        .arg(pagesText(p.current).toString())
+        .arg(QString::fromStdString(PrintManager::fmt(p.current.startTime)))
+        .arg(p.pagesPrinted())
+        .arg(timeToSec(p.remain), 0, 'f', 1);
     }
+    if (text.isEmpty()) text = "当前无正在打印的任务\n";
+    for (const auto& j : snap->held) {
+        text += QString("已暂停: 任务ID %1 | 用户 %2 | 文档 %3 | 已打印 %4/%5 页\n")
+            .arg(j.id)
+            .arg(toQString(j.userName()))
+            .arg(toQString(j.docName()))
+            .arg(j.donePages)
+            .arg(j.pages);
+    }
+    runningText->setText(text);
 }
 
 void MainWindow::refreshDoneTable()
 {
-    doneTable->setRowCount(pm.done.size());
-    
-    for (size_t i = 0; i < pm.done.size(); ++i) {
-        const auto& j = pm.done[i];
-        doneTable->setItem(i, 0, new QTableWidgetItem(QString::number(j.id)));
-        doneTable->setItem(i, 1, new QTableWidgetItem(QString::fromStdString(j.user)));
-        doneTable->setItem(i, 2, new QTableWidgetItem(QString::fromStdString(j.doc)));
-        doneTable->setItem(i, 3, new QTableWidgetItem(QString::number(j.pages)));
-        doneTable->setItem(i, 4, new QTableWidgetItem(QString::fromStdString(PrintManager::fmt(j.submitTime))));
-        doneTable->setItem(i, 5, new QTableWidgetItem(QString::fromStdString(PrintManager::fmt(j.startTime))));
-        doneTable->setItem(i, 6, new QTableWidgetItem(QString::fromStdString(PrintManager::fmt(j.finishTime))));
-        doneTable->setItem(i, 7, new QTableWidgetItem(
-            QString("%1 / %2").arg(j.waitTime()).arg(j.duration())));
+    // 只复制上次刷新之后新完成的记录，并告知后台线程可以释放这些增量
+    snap->appendDone(doneJobs);
+    worker.ackDone(doneJobs.end());
+    doneModel->sync();
+}
+
+void MainWindow::onQueryDone()
+{
+    int kind = doneQueryCombo->currentIndex();
+    QString text = doneQueryEdit->text().trimmed();
+    int id = 0;
+    double t1 = 0, t2 = 0;
+    bool ok = true;
+    if (kind == 0) {
+        id = text.toInt(&ok);
+    } else if (kind == 2) {
+        QStringList parts = text.split('-');
+        bool ok2 = false;
+        if (parts.size() == 2) {
+            t1 = parts[0].trimmed().toDouble(&ok);
+            t2 = parts[1].trimmed().toDouble(&ok2);
+        }
+        ok = parts.size() == 2 && ok && ok2 && t1 <= t2;
+    }
+    if (!ok || (kind == 1 && text.isEmpty())) {
+        QMessageBox::warning(this, "输入错误", "请输入任务ID、用户名，或形如 100-200 的完成时间区间（秒）");
+        return;
     }
+
+    std::string user = text.toStdString();
+    worker.post([this, kind, id, user, t1, t2](PrintManager& pm) {
+        auto rows = std::make_shared<std::vector<PrintJob>>();
+        if (kind == 0) {
+            PrintJob j;
+            if (pm.findDone(id, &j)) rows->push_back(j);
+        } else if (kind == 1) {
+            *rows = pm.doneByUser(user, kDoneQueryLimit);
+        } else {
+            *rows = pm.doneBetween(secToTime(t1), secToTime(t2), kDoneQueryLimit);
+        }
+        onGui([this, rows]() { showDoneQuery(*rows); });
+    });
+}
+
+void MainWindow::showDoneQuery(const std::vector<PrintJob>& rows)
+{
+    queryJobs.jobs.assign(rows.begin(), rows.end());
+    queryJobs.first = 0;
+    queryModel->reload();
+    doneTable->setModel(queryModel);
+    QString title = QString("已完成任务（查询结果 %1 条").arg(rows.size());
+    if (rows.size() >= kDoneQueryLimit) title += "，只显示最早的部分";
+    doneGroup->setTitle(title + "）");
+}
+
+void MainWindow::onShowLatestDone()
+{
+    doneTable->setModel(doneModel);
+    doneGroup->setTitle("已完成任务");
+}
+
+void MainWindow::onExportDone()
+{
+    worker.post([this](PrintManager& pm) {
+        pm.saveDone();
+        QString path = QString::fromStdString(pm.fileDone);
+        onGui([this, path]() {
+            QMessageBox::information(this, "导出完成", QString("全部完成记录已导出到 %1").arg(path));
+        });
+    });
 }
 
 void MainWindow::refreshStatistics()
 {
-    auto stats = pm.getStatistics();
-    statsText->setText(QString(
+    const auto& stats = snap->stats;
+    QString text = QString(
         "完成任务数: %1\n"
-        "平均等待时间: %2 秒\n"
-        "平均打印耗时: %3 秒"
+        "平均等待时间: %2 秒（标准差 %3，P50/P95/P99 = %4 / %5 / %6）\n"
+        "平均打印耗时: %7 秒（标准差 %8，P50/P95/P99 = %9 / %10 / %11）\n"
+        "平均利用率: %12%"
     ).arg(stats.totalCompleted)
     .arg(stats.avgWaitTime, 0, 'f', 2)
-    .arg(stats.avgDuration, 0, 'f', 2));
+    .arg(stats.stdWaitTime, 0, 'f', 2)
+    .arg(stats.p50Wait, 0, 'f', 1)
+    .arg(stats.p95Wait, 0, 'f', 1)
+    .arg(stats.p99Wait, 0, 'f', 1)
+    .arg(stats.avgDuration, 0, 'f', 2)
+    .arg(stats.stdDuration, 0, 'f', 2)
+    .arg(stats.p50Duration, 0, 'f', 1)
+    .arg(stats.p95Duration, 0, 'f', 1)
+    .arg(stats.p99Duration, 0, 'f', 1)
+    .arg(stats.utilisation * 100, 0, 'f', 1);
+
+    // 截止时刻：只统计带截止时刻的已完成任务
+    if (stats.deadlineJobs > 0) {
+        text += QString("\n按时完成: %1%（%2 个有截止时刻，迟到 P50/P95/P99 = %3 / %4 / %5 秒）")
+            .arg(stats.onTimePct, 0, 'f', 1)
+            .arg(stats.deadlineJobs)
+            .arg(stats.p50Lateness, 0, 'f', 1)
+            .arg(stats.p95Lateness, 0, 'f', 1)
+            .arg(stats.p99Lateness, 0, 'f', 1);
+    }
+    if (stats.rejected > 0 || stats.demoted > 0 || stats.queueLimit > 0) {
+        text += QString("\n准入控制: 拒绝 %1 个，降级 %2 个，队列上限 %3")
+            .arg(stats.rejected)
+            .arg(stats.demoted)
+            .arg(stats.queueLimit > 0 ? QString::number(stats.queueLimit) : QString("不限"));
+    }
+    
+    // 页数分布（对数分桶）
+    const auto& hist = snap->pageHistogram;
+    if (!hist.empty()) {
+        text += "\n页数分布:";
+        for (size_t k = 0; k < hist.size(); ++k) {
+            if (hist[k] == 0) continue;
+            text += QString(" [%1,%2):%3").arg(1LL << k).arg(1LL << (k + 1)).arg((qulonglong)hist[k]);
+        }
+    }
+    for (const auto& p : stats.printers) {
+        text += QString("\n打印机%1: 利用率 %2% | 完成 %3 个 / %4 页 | %5 个/小时")
+            .arg(p.id + 1)
+            .arg(p.utilisation * 100, 0, 'f', 1)
+            .arg(p.jobsDone)
+            .arg(p.pagesDone)
+            .arg(p.jobsPerHour, 0, 'f', 1);
+    }
+    statsText->setText(text);
 }
 
+void MainWindow::refreshMetrics()
+{
+    if (!kMetricsEnabled) {
+        metricsText->setText("编译时未启用运行时指标（PRINTMANAGER_METRICS=0）");
+        return;
+    }
+    const Metrics& m = Metrics::global();
+    // 事件速率按两次刷新之间的增量计算
+    uint64_t events = m.events.get();
+    uint64_t now = metrics::nowNs();
+    double rate = 0.0;
+    if (lastMetricsNs != 0 && now > lastMetricsNs)
+        rate = (double)(events - lastEvents) / ((double)(now - lastMetricsNs) * 1e-9);
+    lastEvents = events;
+    lastMetricsNs = now;
+
+    auto us = [](double sec) { return sec * 1e6; };
+    QString text = QString(
+        "队列: 等待 %1 | 预约 %2 | 忙碌打印机 %3 | 抢占 %18 次\n"
+        "事件: 累计 %4 | %5 个/秒 | 仿真/墙钟 %6 倍\n"
+        "写日志: %7 次，平均 %8 µs，P99 ≤ %9 µs | 快照 %10 次，平均 %11 ms\n"
+        "写入字节: 日志 %12 | 快照 %13 | 完成日志 %14\n"
+        "界面刷新: %15 次，平均 %16 ms，P99 ≤ %17 ms"
+    ).arg(m.queueDepth.get(), 0, 'f', 0)
+    .arg(m.pendingDepth.get(), 0, 'f', 0)
+    .arg(m.busyPrinters.get(), 0, 'f', 0)
+    .arg((qulonglong)events)
+    .arg(rate, 0, 'f', 0)
+    .arg(m.simSpeedup.get(), 0, 'g', 4)
+    .arg((qulonglong)m.persistLatency.count.load(std::memory_order_relaxed))
+    .arg(us(m.persistLatency.meanSec()), 0, 'f', 1)
+    .arg(us(m.persistLatency.quantile(0.99)), 0, 'f', 1)
+    .arg((qulonglong)m.snapshots.get())
+    .arg(m.snapshotLatency.meanSec() * 1e3, 0, 'f', 1)
+    .arg((qulonglong)m.journalBytes.get())
+    .arg((qulonglong)m.snapshotBytes.get())
+    .arg((qulonglong)m.doneLogBytes.get())
+    .arg((qulonglong)m.uiRefreshLatency.count.load(std::memory_order_relaxed))
+    .arg(m.uiRefreshLatency.meanSec() * 1e3, 0, 'f', 2)
+    .arg(m.uiRefreshLatency.quantile(0.99) * 1e3, 0, 'f', 2)
+    .arg((qulonglong)m.preemptions.get());
+    metricsText->setText(text);
+}
+
+void MainWindow::onDumpMetrics()
+{
+    const std::string path = "data/metrics.prom";
+    if (Metrics::global().dump(path))
+        QMessageBox::information(this, "导出指标", QString("运行时指标已写入 %1").arg(QString::fromStdString(path)));
+    else
+        QMessageBox::warning(this, "导出指标", QString("无法写入 %1").arg(QString::fromStdString(path)));
+}
@@ -3,19 +3,28 @@
 
 #include <QMainWindow>
 #include <QTimer>
-#include <QTableWidget>
+#include <QTableView>
 #include <QLineEdit>
 #include <QPushButton>
 #include <QLabel>
 #include <QSpinBox>
 #include <QDoubleSpinBox>
+#include <QComboBox>
+#include <QCheckBox>
 #include <QTextEdit>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGroupBox>
 #include <QMessageBox>
 #include <QHeaderView>
+#include <QElapsedTimer>
+#include <atomic>
+#include <functional>
 #include "printmanager.h"
+#include "simworker.h"
+#include "jobtablemodel.h"
+#include "workload.h"
+#include "ipc.h"
 
 class MainWindow : public QMainWindow
 {
@@ -28,12 +37,22 @@ public:
 private slots:
     void onAddJob();
     void onCancelJob();
+    void onCancelUserJobs();
+    void onPauseJob();
+    void onResumeJob();
     void onSetSpeed();
+    void onSetPrinters();
+    void onCompareDisciplines();
     void onTick();
     void onRunToEnd();
     void onRandomJobs();
     void onAutoTick(); // 自动推进
+    void onQueryDone();
+    void onShowLatestDone();
+    void onExportDone();
+    void onDumpMetrics();
     void updateDisplay();
+    void scheduleFrame();
 
 private:
     void setupUI();
@@ -41,11 +60,24 @@ private:
     void refreshRunningInfo();
     void refreshDoneTable();
     void refreshStatistics();
+    void refreshMetrics();
     void refreshStatus();
+    void showDoneQuery(const std::vector<PrintJob>& rows);
+    void onGui(std::function<void()> fn);   // 从后台线程把操作转交给界面线程
 
-    PrintManager pm;
-    QTimer *autoTimer;  // 用于自动刷新显示
-    QTimer *autoTickTimer;  // 用于自动推进时间
+    SimWorker worker;                        // 仿真引擎所在的后台线程
+    std::shared_ptr<const SimSnapshot> snap; // 最近一次显示的快照
+    DoneMirror doneJobs;                     // 已完成任务的界面副本（随保留窗口滑动）
+    DoneMirror queryJobs;                    // 最近一次查询的结果
+    std::atomic<bool> refreshQueued{false};
+    QString lastWorkload;                    // 上次使用的工作负载规格
+    QTimer *frameTimer;                      // 单次定时器：把一帧之内的多次发布合并成一次刷新
+    QElapsedTimer frameClock;                // 距上次刷新的时间
+    int frameIntervalMs = 33;                // 刷新预算，约 30 帧/秒
+    MetricsServer metricsServer;             // 环境变量 PRINTMANAGER_METRICS_PORT 设置时提供 /metrics
+    IpcServer ipcServer;                     // 环境变量 PRINTMANAGER_IPC_SOCKET 设置时接受外部提交
+    uint64_t lastEvents = 0;                 // 上次刷新指标面板时的累计事件数和时刻，用于计算速率
+    uint64_t lastMetricsNs = 0;
 
     // UI组件
     QWidget *centralWidget;
@@ -62,12 +94,25 @@ private:
     QGroupBox *controlGroup;
     QDoubleSpinBox *speedSpinBox;
     QPushButton *setSpeedBtn;
+    QSpinBox *printerCountSpinBox;
+    QComboBox *policyCombo;
+    QComboBox *disciplineCombo;
+    QCheckBox *preemptCheck;                 // 页边界抢占
+    QSpinBox *splitSpinBox;                  // 大任务拆分阈值（页），0 为不拆分
+    QComboBox *admissionCombo;               // 准入控制
+    QSpinBox *queueLimitSpinBox;             // 等待队列长度上限，0 为不限
+    QPushButton *compareBtn;
+    QPushButton *setPrintersBtn;
     QPushButton *addJobBtn;
     QPushButton *cancelJobBtn;
+    QPushButton *cancelUserBtn;
+    QPushButton *pauseJobBtn;
+    QPushButton *resumeJobBtn;
     QPushButton *tickBtn;
     QPushButton *runToEndBtn;
     QPushButton *randomJobsBtn;
     QPushButton *autoTickBtn;
+    QSpinBox *paceSpinBox;                   // 实时模式倍速
     QSpinBox *tickSecondsSpinBox;
     
     // 添加任务对话框组件（内嵌）
@@ -75,14 +120,18 @@ private:
     QLineEdit *userEdit;
     QLineEdit *docEdit;
     QSpinBox *pagesSpinBox;
+    QSpinBox *prioritySpinBox;
+    QSpinBox *deadlineSpinBox;               // 截止时刻（提交后秒数），0 为没有
     
     // 取消任务
     QGroupBox *cancelJobGroup;
     QSpinBox *cancelIdSpinBox;
+    QLineEdit *cancelUserEdit;
     
     // 等待队列表格
     QGroupBox *waitingGroup;
-    QTableWidget *waitingTable;
+    QTableView *waitingTable;
+    WaitingTableModel *waitingModel;
     
     // 进行中任务显示
     QGroupBox *runningGroup;
@@ -90,11 +139,23 @@ private:
     
     // 已完成任务表格
     QGroupBox *doneGroup;
-    QTableWidget *doneTable;
+    QTableView *doneTable;
+    DoneTableModel *doneModel;
+    DoneTableModel *queryModel;
+    QComboBox *doneQueryCombo;
+    QLineEdit *doneQueryEdit;
+    QPushButton *doneQueryBtn;
+    QPushButton *doneLatestBtn;
+    QPushButton *doneExportBtn;
     
     // 统计信息
     QGroupBox *statsGroup;
     QTextEdit *statsText;
+
+    // 性能指标
+    QGroupBox *metricsGroup;
+    QTextEdit *metricsText;
+    QPushButton *metricsDumpBtn;
 };
 
 #endif // MAINWINDOW_H
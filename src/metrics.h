@@ -0,0 +1,314 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+#ifndef _WIN32
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// 运行时指标：计数器、瞬时值和延迟直方图，导出为 Prometheus 文本格式。
+//
+// 编译期开关 PRINTMANAGER_METRICS（默认 1；CMake 选项 PRINTMANAGER_METRICS=OFF 时为 0）。
+// 关闭时 kMetricsEnabled 为 false，引擎里的埋点都写成
+//   if (kMetricsEnabled && metrics) ...      以及 ScopedTimer(nullptr)
+// 编译器整体消去，不取时钟、不碰原子变量。
+// 打开时所有更新都是 relaxed 原子操作：引擎线程写，界面线程和 HTTP 线程随时读，无需加锁。
+#ifndef PRINTMANAGER_METRICS
+#define PRINTMANAGER_METRICS 1
+#endif
+
+constexpr bool kMetricsEnabled = PRINTMANAGER_METRICS != 0;
+
+namespace metrics {
+
+inline uint64_t nowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 单调递增的计数
+struct Counter {
+    std::atomic<uint64_t> v{0};
+    void add(uint64_t n = 1) { v.fetch_add(n, std::memory_order_relaxed); }
+    void set(uint64_t n) { v.store(n, std::memory_order_relaxed); }   // 从已有的累计值同步
+    uint64_t get() const { return v.load(std::memory_order_relaxed); }
+};
+
+// 可增可减的瞬时值
+struct Gauge {
+    std::atomic<double> v{0.0};
+    void set(double x) { v.store(x, std::memory_order_relaxed); }
+    double get() const { return v.load(std::memory_order_relaxed); }
+};
+
+// 延迟直方图（纳秒）：第 k 个桶的上界为 2^(k + kMinShift) ns，即 256ns … 约 34s，
+// 更大的值落在最后一个桶（+Inf）。observe 只有一次位运算和两次原子加
+struct Histogram {
+    static constexpr int kMinShift = 8;
+    static constexpr int kBuckets = 28;
+    std::atomic<uint64_t> buckets[kBuckets + 1] = {};
+    std::atomic<uint64_t> sumNs{0};
+    std::atomic<uint64_t> count{0};
+
+    void observe(uint64_t ns) {
+        int k = 0;
+        if (ns > 0) {
+            int bits = bitWidth(ns);
+            k = bits - kMinShift;
+            if (ns == (1ULL << (bits - 1))) --k;   // 恰好是 2 的幂时属于上界等于它的桶
+            if (k < 0) k = 0;
+            if (k > kBuckets) k = kBuckets;
+        }
+        buckets[k].fetch_add(1, std::memory_order_relaxed);
+        sumNs.fetch_add(ns, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // x 的二进制位数（x > 0）；GCC/Clang 与 MSVC x64 用单条指令，其余平台逐位移
+    static int bitWidth(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return 64 - __builtin_clzll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        unsigned long i;
+        _BitScanReverse64(&i, x);
+        return (int)i + 1;
+#else
+        int n = 0;
+        for (; x; x >>= 1) ++n;
+        return n;
+#endif
+    }
+
+    static double upperSec(int k) {
+        return (double)(1ULL << (k + kMinShift)) * 1e-9;
+    }
+
+    // 分位数的近似值（所在桶的上界，秒）；没有样本时为 0
+    double quantile(double q) const {
+        uint64_t n = count.load(std::memory_order_relaxed);
+        if (n == 0) return 0.0;
+        uint64_t want = (uint64_t)(q * (double)n), acc = 0;
+        for (int k = 0; k < kBuckets; ++k) {
+            acc += buckets[k].load(std::memory_order_relaxed);
+            if (acc > want) return upperSec(k);
+        }
+        return upperSec(kBuckets);
+    }
+
+    double meanSec() const {
+        uint64_t n = count.load(std::memory_order_relaxed);
+        return n ? (double)sumNs.load(std::memory_order_relaxed) * 1e-9 / (double)n : 0.0;
+    }
+};
+
+// 作用域计时：析构时把经过的时间记入直方图；h 为空时什么也不做（不取时钟）
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram* hist) : h(hist), t0(hist ? nowNs() : 0) {}
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+    ~ScopedTimer() {
+        if (h) h->observe(nowNs() - t0);
+    }
+
+private:
+    Histogram* h;
+    uint64_t t0;
+};
+
+} // namespace metrics
+
+// 全部指标。进程级实例见 global()；批量实验（参数扫描）的实例不挂接指标
+struct Metrics {
+    // —— 引擎
+    metrics::Counter events;           // advance 处理的事件数
+    metrics::Counter advanceCalls;
+    metrics::Counter simMicros;        // advance 推进的仿真时长（微秒）
+    metrics::Counter advanceWallNs;    // advance 花费的墙钟时间
+    metrics::Histogram advanceLatency;
+    metrics::Gauge simSpeedup;         // 最近一次 advance：仿真秒 / 墙钟秒
+    metrics::Gauge simTime;            // 仿真时钟（秒）
+    metrics::Gauge queueDepth;         // 等待队列长度
+    metrics::Gauge pendingDepth;       // 尚未到达的预约任务数
+    metrics::Gauge busyPrinters;
+    metrics::Gauge doneTotal;          // 累计完成任务数
+    metrics::Counter preemptions;      // 在页边界上被抢占的次数
+    metrics::Counter rejected;         // 准入控制拒绝的提交
+    metrics::Counter demoted;          // 准入控制降级接收的提交
+
+    // —— 持久化
+    metrics::Counter journalEvents;
+    metrics::Histogram persistLatency;   // 每个事件写日志（含按策略 fsync）的耗时
+    metrics::Counter snapshots;
+    metrics::Histogram snapshotLatency;
+    metrics::Counter journalBytes;
+    metrics::Counter snapshotBytes;
+    metrics::Counter doneLogBytes;
+
+    // —— 界面
+    metrics::Histogram uiRefreshLatency;
+
+    static Metrics& global() {
+        static Metrics m;
+        return m;
+    }
+
+    // Prometheus 文本格式（text/plain; version=0.0.4）
+    std::string prometheus() const {
+        std::ostringstream out;
+        out.precision(17);
+        if (!kMetricsEnabled) {
+            out << "# printmanager built with PRINTMANAGER_METRICS=0\n";
+            return out.str();
+        }
+        auto counter = [&out](const char* name, const char* help, double v) {
+            out << "# HELP " << name << " " << help << "\n# TYPE " << name << " counter\n"
+                << name << " " << v << "\n";
+        };
+        auto gauge = [&out](const char* name, const char* help, double v) {
+            out << "# HELP " << name << " " << help << "\n# TYPE " << name << " gauge\n"
+                << name << " " << v << "\n";
+        };
+        auto histogram = [&out](const char* name, const char* help, const metrics::Histogram& h) {
+            out << "# HELP " << name << " " << help << "\n# TYPE " << name << " histogram\n";
+            uint64_t acc = 0;
+            for (int k = 0; k < metrics::Histogram::kBuckets; ++k) {
+                acc += h.buckets[k].load(std::memory_order_relaxed);
+                out << name << "_bucket{le=\"" << metrics::Histogram::upperSec(k) << "\"} " << acc << "\n";
+            }
+            uint64_t n = h.count.load(std::memory_order_relaxed);
+            out << name << "_bucket{le=\"+Inf\"} " << n << "\n"
+                << name << "_sum " << (double)h.sumNs.load(std::memory_order_relaxed) * 1e-9 << "\n"
+                << name << "_count " << n << "\n";
+        };
+        counter("printmanager_events_total", "Events processed by the simulation loop.", (double)events.get());
+        counter("printmanager_advance_calls_total", "Calls to advance (tick / run).", (double)advanceCalls.get());
+        counter("printmanager_sim_seconds_total", "Simulated time advanced.", (double)simMicros.get() * 1e-6);
+        counter("printmanager_advance_wall_seconds_total", "Wall time spent in advance.", (double)advanceWallNs.get() * 1e-9);
+        histogram("printmanager_advance_seconds", "Wall time per advance call.", advanceLatency);
+        gauge("printmanager_sim_speedup", "Simulated seconds per wall second in the last advance.", simSpeedup.get());
+        gauge("printmanager_sim_time_seconds", "Current simulation clock.", simTime.get());
+        gauge("printmanager_queue_depth", "Jobs in the waiting queue.", queueDepth.get());
+        gauge("printmanager_pending_jobs", "Scheduled jobs that have not arrived yet.", pendingDepth.get());
+        gauge("printmanager_busy_printers", "Printers currently printing.", busyPrinters.get());
+        gauge("printmanager_done_jobs", "Completed jobs.", doneTotal.get());
+        counter("printmanager_preemptions_total", "Running jobs preempted at a page boundary.", (double)preemptions.get());
+        counter("printmanager_admission_rejected_total", "Submissions rejected by admission control.", (double)rejected.get());
+        counter("printmanager_admission_demoted_total", "Submissions admitted at lowest priority by admission control.", (double)demoted.get());
+        counter("printmanager_journal_events_total", "Events appended to the journal.", (double)journalEvents.get());
+        histogram("printmanager_persist_seconds", "Journal append latency per event, including fsync.", persistLatency);
+        counter("printmanager_snapshots_total", "Full snapshots written.", (double)snapshots.get());
+        histogram("printmanager_snapshot_seconds", "Full snapshot latency.", snapshotLatency);
+        counter("printmanager_journal_bytes_total", "Bytes written to the journal.", (double)journalBytes.get());
+        counter("printmanager_snapshot_bytes_total", "Bytes written by snapshots.", (double)snapshotBytes.get());
+        counter("printmanager_donelog_bytes_total", "Bytes written to the binary done log.", (double)doneLogBytes.get());
+        histogram("printmanager_ui_refresh_seconds", "GUI refresh latency.", uiRefreshLatency);
+        return out.str();
+    }
+
+    // 写到文件（先写 .tmp 再改名，抓取方不会读到半个文件）
+    bool dump(const std::string& path) const {
+        {
+            std::ofstream fout(path + ".tmp", std::ios::trunc);
+            if (!fout) return false;
+            fout << prometheus();
+            if (!fout) return false;
+        }
+#ifdef _WIN32
+        std::remove(path.c_str());
+#endif
+        return std::rename((path + ".tmp").c_str(), path.c_str()) == 0;
+    }
+};
+
+// 本机 HTTP 端点：只监听 127.0.0.1，对任何请求都返回 body() 的内容（通常是 prometheus()）。
+// 在自己的线程上逐个处理连接；Windows 上不支持，start() 返回 false
+class MetricsServer {
+public:
+    MetricsServer() = default;
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+    ~MetricsServer() { stop(); }
+
+    bool start(int port, std::function<std::string()> body) {
+#ifdef _WIN32
+        (void)port;
+        (void)body;
+        return false;
+#else
+        stop();
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons((uint16_t)port);
+        if (::bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(fd, 8) != 0) {
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+        quit = false;
+        th = std::thread([this, body = std::move(body)]() { serve(body); });
+        return true;
+#endif
+    }
+
+    void stop() {
+#ifndef _WIN32
+        if (fd < 0) return;
+        quit = true;
+        if (th.joinable()) th.join();
+        ::close(fd);
+        fd = -1;
+#endif
+    }
+
+private:
+#ifndef _WIN32
+    void serve(const std::function<std::string()>& body) {
+        while (!quit) {
+            pollfd p{fd, POLLIN, 0};
+            if (::poll(&p, 1, 200) <= 0) continue;   // 超时后检查是否该退出
+            int c = ::accept(fd, nullptr, nullptr);
+            if (c < 0) continue;
+            char req[1024];
+            pollfd pc{c, POLLIN, 0};
+            if (::poll(&pc, 1, 1000) > 0) (void)::recv(c, req, sizeof(req), 0);   // 请求内容不重要
+            std::string text = body();
+            std::string resp = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                               "Content-Length: " + std::to_string(text.size()) +
+                               "\r\nConnection: close\r\n\r\n" + text;
+            size_t off = 0;
+            while (off < resp.size()) {
+                ssize_t n = ::send(c, resp.data() + off, resp.size() - off, MSG_NOSIGNAL);
+                if (n <= 0) break;
+                off += (size_t)n;
+            }
+            ::close(c);
+        }
+    }
+
+    int fd = -1;
+    std::atomic<bool> quit{false};
+    std::thread th;
+#endif
+};
+
+#endif // METRICS_H
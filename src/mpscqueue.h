@@ -0,0 +1,57 @@
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+#include <utility>
+
+// 多生产者单消费者无锁队列（Vyukov 链表队列）。
+// push() 可在任意线程调用，只有一次原子交换；pop()/empty() 只能由唯一的消费者线程调用。
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() {
+        Node* stub = new Node();
+        head.store(stub, std::memory_order_relaxed);
+        tail = stub;
+    }
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+    ~MpscQueue() {
+        T tmp;
+        while (pop(tmp)) {}
+        delete tail;
+    }
+
+    void push(T value) {
+        Node* n = new Node();
+        n->value = std::move(value);
+        Node* prev = head.exchange(n, std::memory_order_acq_rel);
+        prev->next.store(n, std::memory_order_seq_cst);
+    }
+
+    bool pop(T& out) {
+        Node* t = tail;
+        Node* next = t->next.load(std::memory_order_acquire);
+        if (!next) return false;
+        out = std::move(next->value);
+        next->value = T();
+        tail = next;
+        delete t;
+        return true;
+    }
+
+    // 生产者已交换 head 但尚未链接 next 的瞬间也会返回 true，稍后重试即可
+    bool empty() const {
+        return tail->next.load(std::memory_order_seq_cst) == nullptr;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value{};
+    };
+    std::atomic<Node*> head;
+    Node* tail;
+};
+
+#endif // MPSCQUEUE_H
@@ -8,226 +8,1896 @@
 #include <cmath>
 #include <sstream>
 #include <iomanip>
+#include <climits>
+#include <algorithm>
+#include <cstdio>
+#include <string_view>
+#include <unordered_map>
+#include <map>
+#include <type_traits>
+#include <functional>
+#include "simtime.h"
+#include "journal.h"
+#include "csvreader.h"
+#include "jobqueue.h"
+#include "stats.h"
+#include "stringpool.h"
+#include "donelog.h"
+#include "donestore.h"
+#include "metrics.h"
+#include "idallocator.h"
 
+// 用户名和文档名存放在进程级字符串池中，任务本身只记编号和位置，
+// 是平凡可复制的定长记录：入队、出队、复制快照都只是内存拷贝。
 struct PrintJob {
     int id = -1;
-    std::string user;
-    std::string doc;
+    UserId user = 0;    // 用户名编号
+    DocRef doc;         // 文档名在字节区中的位置
     int pages = 0;
-    int submitTime = 0; // 提交时刻（秒）
-    int startTime = -1;
-    int finishTime = -1;
+    int donePages = 0;  // 已打印完的页数（被抢占或暂停后重新排队的任务从这里接着打）
+    int priority = 0;   // 优先级，越大越优先
+    SimTime submitTime = 0;   // 提交时刻（微秒，见 simtime.h）
+    SimTime startTime = -1;
+    SimTime finishTime = -1;
+    int parent = 0;     // 拆分任务的分段：母任务 ID（见 PrintManager::splitPages）；普通任务为 0
+    int firstPage = 0;  // 分段的起始页（从 1 开始）
+    SimTime deadline = -1;    // 截止时刻（绝对时刻，见 PrintManager::admit）；-1 表示没有
 
-    int waitTime() const {
+    // 等待时长（到第一次开始打印）、打印时长（秒，含被抢占、暂停的时间）；尚未发生时为 -1
+    double waitSec() const {
         if (startTime < 0) return -1;
-        return startTime - submitTime;
+        return timeToSec(startTime - submitTime);
     }
-    int duration() const {
+    double durationSec() const {
         if (finishTime < 0 || startTime < 0) return -1;
-        return finishTime - startTime;
+        return timeToSec(finishTime - startTime);
     }
+    // 完成时刻超过截止时刻的秒数，按时完成时不大于 0
+    double latenessSec() const {
+        return timeToSec(finishTime - deadline);
+    }
+    // 剩余页数（SRPT 排序用）。正在打印的任务的实时剩余页数见 Printer::pagesUnfinished
+    int remainingPages() const {
+        return pages - donePages;
+    }
+
+    std::string_view userName() const { return StringPool::global().user(user); }
+    std::string_view docName() const { return StringPool::global().doc(doc); }
+};
+static_assert(std::is_trivially_copyable<PrintJob>::value, "PrintJob 必须可按字节复制");
+
+// 一条待提交的任务（批量仿真、规则对比用）
+struct JobSpec {
+    UserId user = 0;
+    DocRef doc;
+    int pages = 0;
+    SimTime submitTime = 0;
+    int priority = 0;
+    SimTime deadline = -1;
 };
 
-static inline std::string csvEscape(const std::string& s) {
-    bool need = false;
-    for (char c : s) {
-        if (c == '"' || c == ',' || c == '\n' || c == '\r') { need = true; break; }
+// 等待队列：id 索引（O(1) 取消/查找）+ 可选的堆排序规则（O(log n) 出队）
+using JobQueue = IndexedQueue<PrintJob>;
+
+// 完成记录的热数据窗口：环形缓冲区 + ID/用户/完成时刻索引
+using DoneStore = DoneRing<PrintJob>;
+
+// 一台打印机：各自的速度、正在打印的任务和累计统计。
+// 当前任务的进度按页计：remain 是剩余页数在当前速度下所需的时间，
+// 换速度时剩余页数不变、按新速度重算 remain（见 setSpeed）。
+// 页边界由 remain 推出（剩余时间恰为整数页的打印时间），按页计数允许 2 微秒的舍入误差。
+struct Printer {
+    int id = 0;
+    double secPerPage = 2.0;  // 速度：秒/页
+    bool busy = false;        // 是否忙
+    PrintJob current;         // 正在打印的任务
+    SimTime remain = 0;       // 当前任务剩余的打印时间（微秒）
+
+    SimTime busyTime = 0;     // 累计打印时长（微秒）
+    int jobsDone = 0;         // 完成任务数
+    long long pagesDone = 0;  // 完成页数
+
+    // 按当前速度打印 pages 页所需的时间
+    SimTime printTime(double pages) const {
+        return secToTime(pages * secPerPage);
+    }
+
+    // 当前任务尚未打印的页数（正在打印的那一页按已完成的比例计，可带小数）
+    double pagesLeft() const {
+        return busy ? timeToSec(remain) / secPerPage : 0.0;
+    }
+
+    // 当前任务尚未打完的整页数（正在打印的那一页算一页）
+    int pagesUnfinished() const {
+        if (!busy) return 0;
+        double perPage = secPerPage * (double)kTicksPerSec;
+        return std::max(0, (int)std::ceil(((double)remain - 2) / perPage));
     }
-    if (!need) return s;
-    std::string out = "\"";
-    for (char c : s) {
-        if (c == '"') out += "\"\""; else out += c;
+
+    // 当前任务已打印完的整页数（包括被抢占、暂停之前打完的）
+    int pagesPrinted() const {
+        if (!busy) return 0;
+        return std::max(0, current.pages - pagesUnfinished());
+    }
+
+    // 距正在打印的这一页打完还需的时间；不超过 2 微秒时视为恰在页边界上
+    SimTime toPageEnd() const {
+        double perPage = secPerPage * (double)kTicksPerSec;
+        int whole = (int)std::floor(((double)remain + 2) / perPage);
+        return std::max<SimTime>(0, remain - printTime(whole));
     }
-    out += "\"";
-    return out;
-}
+
+    // 改变速度：正在打印的任务剩余页数不变，剩余时间按新速度换算
+    void setSpeed(double sec_per_page) {
+        if (busy && secPerPage > 0) remain = std::llround((double)remain * (sec_per_page / secPerPage));
+        secPerPage = sec_per_page;
+    }
+};
+
+// 调度策略：空闲打印机取哪个任务、任务交给哪台空闲打印机
+enum class DispatchPolicy {
+    Fifo = 0,           // 先来先服务，交给编号最小的空闲打印机
+    ShortestJobFirst,   // 页数最少的任务优先
+    LeastLoaded,        // 先来先服务，交给累计打印时长最少的空闲打印机
+    FairShare           // 已占用页数最少的用户优先，同一用户内先来先服务
+};
+
+// 准入控制：预计赶不上截止时刻的任务如何处理（见 PrintManager::admit）
+enum class AdmissionPolicy {
+    Off = 0,   // 照常接收
+    Reject,    // 拒绝，addJob 返回 0
+    Demote     // 接收，但优先级降为 kDemotedPriority（只在按优先级出队的规则下起作用）
+};
 
 struct PrintManager {
-    int currentTime = 0;      // 仿真时钟（秒）
-    double secPerPage = 2.0;  // 速度：秒/页（支持小数）
-    int nextId      = 1;
+    SimTime currentTime = 0;  // 仿真时钟（微秒；界面按秒显示，见 fmt）
+    double secPerPage = 2.0;  // 默认速度：秒/页（新增打印机使用）
+    int nextId      = 1;          // 大于已分配的全部 ID
+    // 非空时从共享的分配器按块领取 ID（多个分片共用一个 ID 空间，见 shardedmanager.h）
+    IdAllocator* idAlloc = nullptr;
+    int idBlockNext = 0;          // 当前块中下一个可用的 ID
+    int idBlockEnd = 0;
 
-    std::queue<PrintJob> waitQ;   // 等待队列（FIFO）
-    std::vector<PrintJob> done;   // 完成日志
+    JobQueue waitQ;               // 等待队列（按 ID 索引，出队顺序见 discipline）
+    // 尚未到达的任务（提交时刻在未来），按到达时刻排序的小根堆
+    struct ArrivesLater {
+        bool operator()(const PrintJob& a, const PrintJob& b) const {
+            if (a.submitTime != b.submitTime) return a.submitTime > b.submitTime;
+            return a.id > b.id;
+        }
+    };
+    std::priority_queue<PrintJob, std::vector<PrintJob>, ArrivesLater> pending;
+    // 流式任务源（例如 WorkloadGenerator）：每次产出下一个任务，提交时刻单调不减，
+    // 没有更多任务时返回 false。只有上一个取出的任务到达后才取下一个，
+    // 尚未到达的那一个暂存在 sourceHead，不会一次生成整批。
+    // 任务到达时才提交（准入控制按到达时的积压判断），之后和手动添加的一样写入日志；源本身不持久化。
+    std::function<bool(JobSpec&)> source;
+    JobSpec sourceHead;           // 从源取出、尚未到达的任务
+    bool hasSourceHead = false;
+    // 完成记录：内存里只保留最近 10 万条（done.maxJobs / done.maxAge 可调，0 为不限，
+    // maxAge 以微秒计），更早的记录在 done.bin 中，经由下面的查询接口读取
+    DoneStore done{100000};
+    StatsAccumulator doneStats;   // 完成任务的增量统计（随完成事件更新）
 
-    bool busy = false;       // 打印机是否忙
-    PrintJob current;        // 正在打印的任务
-    int remainSec = 0;       // 当前任务剩余"整秒数"（向上取整）
+    std::vector<Printer> printers = std::vector<Printer>(1);   // 打印机池
+    DispatchPolicy policy = DispatchPolicy::Fifo;
+    QueueDiscipline discipline = QueueDiscipline::Fifo;   // 等待队列出队规则
+    double agingRate = 0.01;                               // AgingPriority：每秒提升的优先级
+    std::unordered_map<UserId, long long> userPages;          // 各用户已占用页数（公平调度）
+    // 抢占：等待队列的队首按出队规则严格排在某台打印机的当前任务之前时，
+    // 该任务在打完当前这一页后让出打印机，剩余页数重新排队（见 preemptAtPageEnd）
+    bool preempt = false;
+    long long preemptCount = 0;   // 本进程内发生的抢占次数（不持久化）
+    std::map<int, PrintJob> held;   // 已暂停的任务（按 ID），恢复后回到等待队列
+    // 拆分：页数超过 splitPages 的任务在提交时按页码区间均分成若干段（不超过打印机台数），
+    // 各段像普通任务一样排队、分配，可以同时在几台打印机上打印。0 表示不拆分
+    int splitPages = 0;
+    struct SplitJob {
+        PrintJob job;     // 母任务；startTime / finishTime 随已完成的段更新为最早开始 / 最晚完成
+        int chunks = 0;   // 段数，各段的 ID 为 job.id + 1 .. job.id + chunks
+        int left = 0;     // 尚未完成的段数
+    };
+    std::unordered_map<int, SplitJob> splits;   // 尚有分段未完成的拆分任务（按母任务 ID）
+    // 准入控制：queueLimit 为等待队列长度上限（0 为不限），队列满时新提交一律拒绝；
+    // admission 决定有截止时刻、预计赶不上的任务是拒绝还是降级接收
+    AdmissionPolicy admission = AdmissionPolicy::Off;
+    int queueLimit = 0;
+    static constexpr int kDemotedPriority = -1000000;   // 低于任何正常的优先级
+    long long rejectCount = 0;    // 本进程内被拒绝、降级的提交数（不持久化）
+    long long demoteCount = 0;
 
     // —— 文件名（可按需修改）
     std::string fileWaiting = "data/waiting.csv";
     std::string fileRunning = "data/running.csv";
-    std::string fileDone    = "data/done.csv";
+    std::string fileDone    = "data/done.csv";   // 按需导出的文本完成记录（saveDone）
+    std::string fileState   = "data/state.csv";
+    std::string filePrinters = "data/printers.csv";
+    std::string fileSplits  = "data/splits.csv";
+
+    // 把全部数据文件（快照、日志、完成日志）放到目录 dir 下，文件名不变
+    void setDataDir(const std::string& dir) {
+        std::string d = dir.empty() || dir.back() == '/' ? dir : dir + "/";
+        fileWaiting = d + "waiting.csv";
+        fileRunning = d + "running.csv";
+        fileDone = d + "done.csv";
+        fileState = d + "state.csv";
+        filePrinters = d + "printers.csv";
+        fileSplits = d + "splits.csv";
+        journal.path = d + "journal.log";
+        doneLog.path = d + "done.bin";
+        doneLog.stringsPath = d + "done.str";
+    }
+
+    // —— 预写日志：每个事件 O(1) 追加，每 snapshotEvery 个事件做一次完整快照
+    bool persist = true;          // false 时不写任何文件（批量仿真、规则对比）
+    Journal journal;
+    DoneLogWriter doneLog;        // 二进制列式完成日志 data/done.bin（完成时追加，快照时落盘）
+    DoneLogReader coldLog;        // 查询已逐出内存的完成记录时映射 done.bin
+    std::unordered_map<uint64_t, DocRef> coldDocs;   // done.str 偏移 → 字符串池中的文档名
+    long long snapshotEvery = 10000;
+    SimTime clockLogEvery = secToTime(60);   // 没有事件时，时钟每跨过一个整 clockLogEvery 才记一条 T
+    unsigned long long eventsLogged = 0;     // 累计写入日志的事件数（advance 据此判断本次是否处理过事件）
+    SimTime clockLogged = 0;                 // 日志（或快照）最近一次记下的时钟
+    mutable unsigned long long snapshotBytes = 0;   // 累计写出的快照字节数（日志字节数见 journal.bytesWritten）
+
+    // —— 运行时指标（见 metrics.h）；为空时不记录。批量实验的实例应置空，免得多线程争用同一组计数器
+    Metrics* metrics = kMetricsEnabled ? &Metrics::global() : nullptr;
 
-    // —— 工具：格式化时间（把秒格式化为 mm:ss）
-    static std::string fmt(int sec) {
-        if (sec < 0) return "-";
-        int m = sec / 60, s = sec % 60;
+    // —— 工具：格式化时间（把时刻格式化为 mm:ss，不足一秒的部分舍去）
+    static std::string fmt(SimTime t) {
+        if (t < 0) return "-";
+        long long sec = t / kTicksPerSec;
         char buf[32];
-        snprintf(buf, sizeof(buf), "%02d:%02d", m, s);
+        snprintf(buf, sizeof(buf), "%02lld:%02lld", sec / 60, sec % 60);
         return std::string(buf);
     }
 
     // ========== 持久化 ==========
+    // 快照文件先写到 .tmp 再改名，避免写到一半时崩溃留下残缺文件
+    static void commitFile(const std::string& path) {
+        std::string tmp = path + ".tmp";
+#ifdef _WIN32
+        std::remove(path.c_str());
+#endif
+        std::rename(tmp.c_str(), path.c_str());
+    }
+
+    void countBytes(std::ofstream& fout) const {
+        std::streamoff n = fout.tellp();
+        if (n > 0) snapshotBytes += (unsigned long long)n;
+    }
+
+    // 等待队列之后是已暂停的任务（held = 1）和尚未到达的预约任务（submitTime > currentTime），恢复时据此区分
     void saveWaiting() const {
-        std::ofstream fout(fileWaiting, std::ios::trunc);
-        fout << "id,user,doc,pages,submitTime,startTime,finishTime\n";
-        std::queue<PrintJob> tmp = waitQ;
-        while (!tmp.empty()) {
-            const auto& j = tmp.front();
-            fout << j.id << ","
-                 << csvEscape(j.user) << ","
-                 << csvEscape(j.doc)  << ","
-                 << j.pages << ","
-                 << j.submitTime << ","
-                 << j.startTime  << ","
-                 << j.finishTime << "\n";
-            tmp.pop();
+        {
+            std::ofstream fout(fileWaiting + ".tmp", std::ios::trunc);
+            fout << "id,user,doc,pages,submitTime,startTime,finishTime,priority,donePages,held,parent,firstPage,deadline\n";
+            auto row = [&fout](const PrintJob& j, bool paused) {
+                fout << j.id << ","
+                     << csvEscape(j.userName()) << ","
+                     << csvEscape(j.docName())  << ","
+                     << j.pages << ","
+                     << timeText(j.submitTime) << ","
+                     << timeText(j.startTime)  << ","
+                     << timeText(j.finishTime) << ","
+                     << j.priority << ","
+                     << j.donePages << ","
+                     << (paused ? 1 : 0) << ","
+                     << j.parent << ","
+                     << j.firstPage << ","
+                     << timeText(j.deadline) << "\n";
+            };
+            for (const auto& j : waitQ) row(j, false);
+            for (const auto& h : held) row(h.second, true);
+            auto future = pending;
+            while (!future.empty()) {
+                row(future.top(), false);
+                future.pop();
+            }
+            countBytes(fout);
         }
+        commitFile(fileWaiting);
     }
 
     void saveRunning() const {
-        std::ofstream fout(fileRunning, std::ios::trunc);
-        fout << "id,user,doc,pages,submitTime,startTime,finishTime,remainSec\n";
-        if (busy) {
-            fout << current.id << ","
-                 << csvEscape(current.user) << ","
-                 << csvEscape(current.doc)  << ","
-                 << current.pages << ","
-                 << current.submitTime << ","
-                 << current.startTime  << ","
-                 << current.finishTime << ","
-                 << remainSec << "\n";
-        }
-    }
-
-    void saveDone() const {
-        std::ofstream fout(fileDone, std::ios::trunc);
-        fout << "id,user,doc,pages,submitTime,startTime,finishTime\n";
-        for (const auto& j : done) {
-            fout << j.id << ","
-                 << csvEscape(j.user) << ","
-                 << csvEscape(j.doc)  << ","
-                 << j.pages << ","
-                 << j.submitTime << ","
-                 << j.startTime  << ","
-                 << j.finishTime << "\n";
-        }
-    }
-
-    void saveAll() const {
+        {
+            std::ofstream fout(fileRunning + ".tmp", std::ios::trunc);
+            fout << "id,user,doc,pages,submitTime,startTime,finishTime,remainSec,printer,priority,donePages,parent,firstPage,deadline\n";
+            for (const auto& p : printers) {
+                if (!p.busy) continue;
+                const auto& j = p.current;
+                fout << j.id << ","
+                     << csvEscape(j.userName()) << ","
+                     << csvEscape(j.docName())  << ","
+                     << j.pages << ","
+                     << timeText(j.submitTime) << ","
+                     << timeText(j.startTime)  << ","
+                     << timeText(j.finishTime) << ","
+                     << timeText(p.remain) << ","
+                     << p.id << ","
+                     << j.priority << ","
+                     << j.donePages << ","
+                     << j.parent << ","
+                     << j.firstPage << ","
+                     << timeText(j.deadline) << "\n";
+            }
+            countBytes(fout);
+        }
+        commitFile(fileRunning);
+    }
+
+    void savePrinters() const {
+        {
+            std::ofstream fout(filePrinters + ".tmp", std::ios::trunc);
+            fout << "id,secPerPage,busySec,jobsDone,pagesDone\n";
+            for (const auto& p : printers) {
+                fout << p.id << ","
+                     << std::setprecision(17) << p.secPerPage << ","
+                     << timeText(p.busyTime) << ","
+                     << p.jobsDone << ","
+                     << p.pagesDone << "\n";
+            }
+            countBytes(fout);
+        }
+        commitFile(filePrinters);
+    }
+
+    // 尚未全部完成的拆分任务（母任务本身不在任何队列里，各段见 waiting.csv / running.csv）
+    void saveSplits() const {
+        {
+            std::ofstream fout(fileSplits + ".tmp", std::ios::trunc);
+            fout << "id,user,doc,pages,submitTime,startTime,finishTime,priority,chunks,left,deadline\n";
+            for (const auto& e : splits) {
+                const auto& j = e.second.job;
+                fout << j.id << ","
+                     << csvEscape(j.userName()) << ","
+                     << csvEscape(j.docName())  << ","
+                     << j.pages << ","
+                     << timeText(j.submitTime) << ","
+                     << timeText(j.startTime)  << ","
+                     << timeText(j.finishTime) << ","
+                     << j.priority << ","
+                     << e.second.chunks << ","
+                     << e.second.left << ","
+                     << timeText(j.deadline) << "\n";
+            }
+            countBytes(fout);
+        }
+        commitFile(fileSplits);
+    }
+
+    // 把全部完成记录（含已逐出内存的）导出为文本 CSV（按需调用；快照只追加二进制完成日志）
+    void saveDone() {
+        {
+            std::ofstream fout(fileDone + ".tmp", std::ios::trunc);
+            fout << "id,user,doc,pages,submitTime,startTime,finishTime,priority,parent,firstPage,deadline\n";
+            forEachDone([&](const PrintJob& j) {
+                fout << j.id << ","
+                     << csvEscape(j.userName()) << ","
+                     << csvEscape(j.docName())  << ","
+                     << j.pages << ","
+                     << timeText(j.submitTime) << ","
+                     << timeText(j.startTime)  << ","
+                     << timeText(j.finishTime) << ","
+                     << j.priority << ","
+                     << j.parent << ","
+                     << j.firstPage << ","
+                     << timeText(j.deadline) << "\n";
+            });
+            countBytes(fout);
+        }
+        commitFile(fileDone);
+    }
+
+    // 时钟、速度、下一个 ID 以及快照编号；最后写入，作为快照的提交点
+    void saveState(long long epoch) const {
+        {
+            std::ofstream fout(fileState + ".tmp", std::ios::trunc);
+            fout << "currentTime,secPerPage,nextId,epoch,policy,discipline,agingRate,doneRows,preempt,splitPages,"
+                    "admission,queueLimit\n";
+            fout << timeText(currentTime) << ","
+                 << std::setprecision(17) << secPerPage << ","
+                 << nextId << ","
+                 << epoch << ","
+                 << (int)policy << ","
+                 << (int)discipline << ","
+                 << agingRate << ","
+                 << doneLog.rows() << ","
+                 << (preempt ? 1 : 0) << ","
+                 << splitPages << ","
+                 << (int)admission << ","
+                 << queueLimit << "\n";
+            countBytes(fout);
+        }
+        commitFile(fileState);
+    }
+
+    // 完整快照：重写全部 CSV，然后截断日志进入新的 epoch
+    void saveAll() {
+        if (!persist) return;
+        metrics::ScopedTimer timer(metricsOn() ? &metrics->snapshotLatency : nullptr);
+        journal.flush(true);
+        long long epoch = journal.epoch + 1;
         saveWaiting();
         saveRunning();
-        saveDone();
+        doneLog.flush(true);   // 完成记录只追加，快照时无需重写
+        savePrinters();
+        saveSplits();
+        saveState(epoch);
+        journal.reset(epoch);
+        clockLogged = currentTime;
+        if (metricsOn()) metrics->snapshots.add();
+    }
+
+    // ========== 恢复 ==========
+    // 从快照（data/*.csv）加载状态，再重放同一 epoch 的日志。
+    // 文件不存在时保持空状态；返回是否读到了任何快照或日志。
+    // 时刻在文件中以十进制秒记录，旧版的整数秒同样可读。
+    bool load() {
+        waitQ.clear();
+        held.clear();
+        splits.clear();
+        pending = decltype(pending)();
+        source = nullptr;
+        hasSourceHead = false;
+        done.clear();
+        coldLog.close();   // 下面可能截断 done.bin，先解除映射
+        coldDocs.clear();
+        doneStats.clear();
+        userPages.clear();
+        printers.assign(1, Printer());
+        printers[0].secPerPage = secPerPage;
+        currentTime = 0;
+        nextId = 1;
+        idBlockNext = idBlockEnd = 0;   // 恢复后由调用者把共享分配器提到 nextId 之上
+
+        bool found = false;
+        long long epoch = 0;
+        bool haveState = false;
+        long long doneRows = -1;   // 快照时完成日志的行数；旧版 state.csv 没有这一列
+        std::vector<std::string_view> f;
+
+        {
+            CsvReader in(fileState);
+            if (in.isOpen() && in.next(f) && in.next(f) && f.size() >= 4) {
+                currentTime = parseTime(f[0]);
+                secPerPage  = CsvReader::toDouble(f[1], secPerPage);
+                nextId      = CsvReader::toInt(f[2], 1);
+                epoch       = std::atoll(std::string(f[3]).c_str());
+                if (f.size() >= 5) policy = (DispatchPolicy)CsvReader::toInt(f[4]);
+                if (f.size() >= 7) {
+                    discipline = (QueueDiscipline)CsvReader::toInt(f[5]);
+                    agingRate  = CsvReader::toDouble(f[6], agingRate);
+                }
+                if (f.size() >= 8) doneRows = std::atoll(std::string(f[7]).c_str());
+                if (f.size() >= 9) preempt = CsvReader::toInt(f[8]) != 0;
+                if (f.size() >= 10) splitPages = CsvReader::toInt(f[9]);
+                if (f.size() >= 12) {
+                    admission = (AdmissionPolicy)CsvReader::toInt(f[10]);
+                    queueLimit = CsvReader::toInt(f[11]);
+                }
+                haveState = true;
+                found = true;
+            }
+        }
+        printers[0].secPerPage = secPerPage;
+        applyDiscipline();
+        {
+            CsvReader in(filePrinters);
+            if (in.isOpen()) {
+                in.next(f);
+                std::vector<Printer> loaded;
+                while (in.next(f)) {
+                    if (f.size() < 5) continue;
+                    Printer p;
+                    p.id         = (int)loaded.size();
+                    p.secPerPage = CsvReader::toDouble(f[1], secPerPage);
+                    p.busyTime   = parseTime(f[2]);
+                    p.jobsDone   = CsvReader::toInt(f[3]);
+                    p.pagesDone  = std::atoll(std::string(f[4]).c_str());
+                    loaded.push_back(p);
+                }
+                if (!loaded.empty()) printers.swap(loaded);
+            }
+        }
+
+        int maxId = 0;
+        SimTime maxTime = currentTime;
+        StringPool& strings = StringPool::global();
+        auto readJob = [&maxId, &maxTime, &strings](const std::vector<std::string_view>& r, PrintJob& j) {
+            if (r.size() < 7) return false;
+            j.id         = CsvReader::toInt(r[0], -1);
+            if (j.id < 0) return false;
+            j.user       = strings.internUser(r[1]);
+            j.doc        = strings.addDoc(r[2]);
+            j.pages      = CsvReader::toInt(r[3]);
+            j.submitTime = parseTime(r[4]);
+            j.startTime  = parseTime(r[5], -1);
+            j.finishTime = parseTime(r[6], -1);
+            j.priority   = 0;
+            j.donePages  = 0;
+            j.parent     = 0;
+            j.firstPage  = 0;
+            j.deadline   = -1;
+            maxId = std::max(maxId, j.id);
+            maxTime = std::max({maxTime, j.startTime, j.finishTime});
+            return true;
+        };
+
+        // 完成记录：读二进制完成日志，截到快照时的行数（之后的由日志重放补上）；
+        // 没有二进制日志时读旧版的 done.csv，并转存进二进制日志。
+        // 超出保留范围的行只计入统计，不读文档名、不进入内存
+        uint64_t keep = 0;
+        if (persist) donelog::upgrade(doneLog.path);   // 第 1 版的整秒时间列
+        {
+            DoneLogReader in;
+            if (in.open(doneLog.path, doneLog.stringsPath) && in.rows() > 0) {
+                found = true;
+                keep = doneRows >= 0 ? std::min<uint64_t>((uint64_t)doneRows, in.rows()) : in.rows();
+                uint64_t hotFrom = done.maxJobs > 0 && keep > done.maxJobs ? keep - done.maxJobs : 0;
+                SimTime hotAfter = LLONG_MIN;
+                if (done.maxAge > 0 && keep > 0) {
+                    donelog::BlockView last = in.block((size_t)((keep - 1) / donelog::kBlockRows));
+                    hotAfter = last.finishTime[(keep - 1) % donelog::kBlockRows] - done.maxAge;
+                }
+                uint64_t n = 0;
+                for (size_t b = 0; b < in.blocks() && n < keep; ++b) {
+                    donelog::BlockView v = in.block(b);
+                    for (uint32_t r = 0; r < v.rows && n < keep; ++r, ++n) {
+                        PrintJob j;
+                        j.id         = v.id[r];
+                        j.user       = strings.internUser(in.string(v.user[r]));
+                        j.pages      = v.pages[r];
+                        j.priority   = v.priority[r];
+                        j.submitTime = v.submitTime[r];
+                        j.startTime  = v.startTime[r];
+                        j.finishTime = v.finishTime[r];
+                        j.parent     = v.parent[r];
+                        j.firstPage  = v.firstPage[r];
+                        j.deadline   = v.deadline[r];
+                        maxId = std::max(maxId, j.id);
+                        maxTime = std::max({maxTime, j.startTime, j.finishTime});
+                        if (j.parent == 0) userPages[j.user] += j.pages;   // 分段的页数由母任务计入
+                        if (n < hotFrom || j.finishTime < hotAfter) {
+                            if (j.parent == 0) countDone(j);
+                            done.skip();
+                            continue;
+                        }
+                        j.doc = strings.addDoc(in.string(v.doc[r]));
+                        recordDone(j, false);
+                    }
+                }
+            }
+        }
+        if (persist) doneLog.truncate(keep);
+        if (done.total() == 0 && doneRows < 0) {
+            CsvReader in(fileDone);
+            if (in.isOpen()) {
+                found = true;
+                in.next(f);   // 表头
+                PrintJob j;
+                while (in.next(f)) {
+                    if (readJob(f, j)) {
+                        if (f.size() >= 8) j.priority = CsvReader::toInt(f[7]);
+                        if (f.size() >= 10) {
+                            j.parent = CsvReader::toInt(f[8]);
+                            j.firstPage = CsvReader::toInt(f[9]);
+                        }
+                        if (f.size() >= 11) j.deadline = parseTime(f[10], -1);
+                        if (j.parent == 0) userPages[j.user] += j.pages;
+                        recordDone(j, persist);
+                    }
+                }
+            }
+        }
+        std::vector<PrintJob> waiting;
+        {
+            CsvReader in(fileWaiting);
+            if (in.isOpen()) {
+                found = true;
+                in.next(f);
+                PrintJob j;
+                while (in.next(f)) {
+                    if (!readJob(f, j)) continue;
+                    if (f.size() >= 8) j.priority = CsvReader::toInt(f[7]);
+                    if (f.size() >= 9) j.donePages = CsvReader::toInt(f[8]);
+                    if (f.size() >= 12) {
+                        j.parent = CsvReader::toInt(f[10]);
+                        j.firstPage = CsvReader::toInt(f[11]);
+                    }
+                    if (f.size() >= 13) j.deadline = parseTime(f[12], -1);
+                    if (f.size() >= 10 && CsvReader::toInt(f[9]) != 0) held[j.id] = j;
+                    else waiting.push_back(std::move(j));
+                }
+            }
+        }
+        {
+            CsvReader in(fileRunning);
+            if (in.isOpen()) {
+                found = true;
+                in.next(f);
+                PrintJob j;
+                while (in.next(f)) {
+                    if (f.size() < 8 || !readJob(f, j)) continue;
+                    if (f.size() >= 10) j.priority = CsvReader::toInt(f[9]);
+                    if (f.size() >= 11) j.donePages = CsvReader::toInt(f[10]);
+                    if (f.size() >= 13) {
+                        j.parent = CsvReader::toInt(f[11]);
+                        j.firstPage = CsvReader::toInt(f[12]);
+                    }
+                    if (f.size() >= 14) j.deadline = parseTime(f[13], -1);
+                    size_t pi = f.size() >= 9 ? (size_t)CsvReader::toInt(f[8]) : 0;
+                    if (pi >= printers.size()) resizePool(pi + 1);
+                    Printer& p = printers[pi];
+                    p.remain = parseTime(f[7]);
+                    userPages[j.user] += j.pages;
+                    p.current = std::move(j);
+                    p.busy = true;
+                }
+            }
+        }
+
+        {
+            CsvReader in(fileSplits);
+            if (in.isOpen()) {
+                in.next(f);
+                PrintJob j;
+                while (in.next(f)) {
+                    if (f.size() < 10 || !readJob(f, j)) continue;
+                    j.priority = CsvReader::toInt(f[7]);
+                    if (f.size() >= 11) j.deadline = parseTime(f[10], -1);
+                    SplitJob& sj = splits[j.id];
+                    sj.job = j;
+                    sj.chunks = CsvReader::toInt(f[8]);
+                    sj.left = CsvReader::toInt(f[9]);
+                    maxId = std::max(maxId, j.id + sj.chunks);
+                }
+            }
+        }
+
+        if (!haveState) currentTime = maxTime;
+        for (auto& j : waiting) {
+            if (j.submitTime > currentTime) pending.push(std::move(j));
+            else waitQ.push(std::move(j));
+        }
+
+        found = replayJournal(epoch, maxId) || found;
+        clockLogged = currentTime;
+
+        nextId = std::max(nextId, maxId + 1);
+        journal.epoch = epoch;
+        return found;
+    }
+
+    // 重放日志。每个事件都是幂等的：快照改名到一半时崩溃，
+    // 日志中已被快照包含的事件会被识别并跳过。
+    // 时钟每前进一次，忙碌打印机的剩余时间和累计时长同步推进，与 advance() 相同，
+    // 因此中途改速度的任务重放后剩余时间与崩溃前一致。
+    bool replayJournal(long long epoch, int& maxId) {
+        CsvReader in(journal.path);
+        if (!in.isOpen()) return false;
+        std::vector<std::string_view> f;
+        if (!in.next(f) || f.empty()) return true;
+        std::string_view head = f[0];
+        if (head.substr(0, 8) != "# epoch ") return true;
+        if (std::atoll(std::string(head.substr(8)).c_str()) != epoch) return true;  // 日志早于快照
+
+        auto clock = [this](std::string_view t) {
+            SimTime now = parseTime(t, currentTime);
+            if (now > currentTime) {
+                for (auto& p : printers) {
+                    if (!p.busy) continue;
+                    p.remain -= now - currentTime;
+                    p.busyTime += now - currentTime;
+                }
+                currentTime = now;
+            }
+            admitArrivals(false);
+        };
+        auto printerAt = [this](std::string_view s) -> Printer* {
+            int i = CsvReader::toInt(s, -1);
+            if (i < 0) return nullptr;
+            if ((size_t)i >= printers.size()) resizePool(i + 1);
+            return &printers[i];
+        };
+        while (in.next(f)) {
+            if (f.empty() || f[0].size() != 1) continue;
+            switch (f[0][0]) {
+            case 'A': {
+                if (f.size() < 6) break;
+                PrintJob j;
+                j.id = CsvReader::toInt(f[1], -1);
+                if (j.id <= maxId) break;   // 已在快照中（ID 单调分配）
+                j.submitTime = parseTime(f[2]);
+                j.user = StringPool::global().internUser(f[3]);
+                j.doc = StringPool::global().addDoc(f[4]);
+                j.pages = CsvReader::toInt(f[5]);
+                if (f.size() >= 7) j.priority = CsvReader::toInt(f[6]);
+                int chunks = f.size() >= 8 ? CsvReader::toInt(f[7], 1) : 1;
+                if (f.size() >= 9) j.deadline = parseTime(f[8], -1);
+                maxId = j.id + (chunks > 1 ? chunks : 0);
+                enqueue(j, chunks, [this](const PrintJob& x) {
+                    if (x.submitTime > currentTime) pending.push(x);
+                    else waitQ.push(x);
+                });
+                break;
+            }
+            case 'C':
+                if (f.size() < 3) break;
+                clock(f[2]);
+                removeJob(CsvReader::toInt(f[1], -1));
+                break;
+            case 'H':
+                if (f.size() < 3) break;
+                clock(f[2]);
+                holdJob(CsvReader::toInt(f[1], -1));
+                break;
+            case 'U':
+                if (f.size() < 3) break;
+                clock(f[2]);
+                releaseJob(CsvReader::toInt(f[1], -1));
+                break;
+            case 'R': {
+                if (f.size() < 4) break;
+                clock(f[2]);
+                Printer* p = printerAt(f[3]);
+                if (!p || !p->busy || p->current.id != CsvReader::toInt(f[1], -1)) break;
+                waitQ.push(takeOff(*p));
+                break;
+            }
+            case 'S': {
+                if (f.size() < 4) break;
+                clock(f[2]);
+                Printer* p = printerAt(f.size() >= 5 ? f[4] : std::string_view("0"));
+                if (!p || p->busy || !removeWaiting(CsvReader::toInt(f[1], -1), &p->current)) break;
+                if (p->current.startTime < 0) p->current.startTime = currentTime;
+                p->busy = true;
+                p->remain = parseTime(f[3]);
+                userPages[p->current.user] += p->current.pages;
+                break;
+            }
+            case 'F': {
+                if (f.size() < 3) break;
+                clock(f[2]);
+                Printer* p = printerAt(f.size() >= 4 ? f[3] : std::string_view("0"));
+                if (!p || !p->busy || p->current.id != CsvReader::toInt(f[1], -1)) break;
+                complete(*p);
+                break;
+            }
+            case 'V':
+                if (f.size() < 3) break;
+                clock(f[1]);
+                secPerPage = CsvReader::toDouble(f[2], secPerPage);
+                for (auto& p : printers) p.setSpeed(secPerPage);
+                break;
+            case 'P': {
+                if (f.size() < 4) break;
+                clock(f[1]);
+                Printer* p = printerAt(f[2]);
+                if (p) p->setSpeed(CsvReader::toDouble(f[3], p->secPerPage));
+                break;
+            }
+            case 'N':
+                if (f.size() < 3) break;
+                clock(f[1]);
+                resizePool(CsvReader::toInt(f[2], (int)printers.size()));
+                break;
+            case 'D':
+                if (f.size() < 3) break;
+                clock(f[1]);
+                policy = (DispatchPolicy)CsvReader::toInt(f[2]);
+                applyDiscipline();
+                break;
+            case 'E':
+                if (f.size() < 3) break;
+                clock(f[1]);
+                preempt = CsvReader::toInt(f[2]) != 0;
+                break;
+            case 'K':
+                if (f.size() < 3) break;
+                clock(f[1]);
+                splitPages = CsvReader::toInt(f[2]);
+                break;
+            case 'M':
+                if (f.size() < 4) break;
+                clock(f[2]);
+                if (CsvReader::toInt(f[3]) == 0) removeJob(CsvReader::toInt(f[1], -1));
+                else demoteJob(CsvReader::toInt(f[1], -1));
+                break;
+            case 'L':
+                if (f.size() < 4) break;
+                clock(f[1]);
+                admission = (AdmissionPolicy)CsvReader::toInt(f[2]);
+                queueLimit = CsvReader::toInt(f[3]);
+                break;
+            case 'Q':
+                if (f.size() < 4) break;
+                clock(f[1]);
+                discipline = (QueueDiscipline)CsvReader::toInt(f[2]);
+                agingRate = CsvReader::toDouble(f[3], agingRate);
+                applyDiscipline();
+                break;
+            case 'T':
+                if (f.size() < 2) break;
+                clock(f[1]);
+                break;
+            }
+        }
+        return true;
     }
 
-    // 追加任务：入队
-    int addJob(const std::string& user, const std::string& doc, int pages) {
+    // 定时调用（例如 GUI 定时器）：让 Interval 策略按时落盘
+    void syncJournal() {
+        journal.poll();
+    }
+
+    // —— 日志事件
+    void logEvent(const std::string& line) {
+        if (!persist) return;
+        {
+            metrics::ScopedTimer timer(metricsOn() ? &metrics->persistLatency : nullptr);
+            journal.append(line);
+        }
+        ++eventsLogged;
+        clockLogged = currentTime;   // 每个事件都发生在当前时刻
+        if (metricsOn()) metrics->journalEvents.add();
+        maybeSnapshot();
+    }
+
+    // 批量操作期间不做快照，整批结束后再检查
+    void maybeSnapshot() {
+        if (snapshotEvery > 0 && journal.events >= snapshotEvery && journal.batchDepth == 0) saveAll();
+    }
+
+    // 批量操作：其间的日志行只同步一次（见 Journal::beginBatch）
+    void beginBatch() {
+        if (persist) journal.beginBatch();
+    }
+    void endBatch() {
+        if (!persist) return;
+        journal.endBatch();
+        maybeSnapshot();
+    }
+
+    // 拆分的任务只记母任务和段数，重放时按同样的规则重新切分；段数和截止时刻没有时省略。
+    // 记下的是准入后的优先级，重放时不再做准入判断
+    void logAdd(const PrintJob& j, int chunks = 1) {
+        if (!persist) return;   // 不持久化时连日志行也不必拼
+        // A 行记的是提交时刻而不是当前时刻，重放时不推进时钟；空转的推进可能没有记 T，
+        // 先补一条，否则恢复后这个已接收的任务会被当成尚未到达的预约任务再判断一次准入
+        if (currentTime > clockLogged) logEvent("T," + timeText(currentTime));
+        std::string line = "A," + std::to_string(j.id) + "," + timeText(j.submitTime) + ","
+                 + csvEscape(j.userName()) + "," + csvEscape(j.docName()) + "," + std::to_string(j.pages) + ","
+                 + std::to_string(j.priority);
+        if (chunks > 1 || j.deadline >= 0) line += "," + std::to_string(chunks);
+        if (j.deadline >= 0) line += "," + timeText(j.deadline);
+        logEvent(line);
+    }
+
+    // ========== 拆分 ==========
+
+    // 按当前打印机台数，pages 页的任务应拆成几段；1 表示不拆分
+    int chunksFor(int pages) const {
+        if (splitPages <= 0 || pages <= splitPages) return 1;
+        long long n = ((long long)pages + splitPages - 1) / splitPages;
+        return (int)std::min<long long>(n, (long long)printers.size());
+    }
+
+    // 一个任务占用的 ID 个数：拆分时母任务之后紧跟各段
+    static int idsFor(int chunks) {
+        return chunks > 1 ? chunks + 1 : 1;
+    }
+
+    // 把任务交给 put：不拆分时原样交出；否则登记母任务，按页码区间均分成 chunks 段
+    // （前 pages % chunks 段各多一页）逐段交出
+    template <typename F>
+    void enqueue(const PrintJob& j, int chunks, F&& put) {
+        if (chunks <= 1) {
+            put(j);
+            return;
+        }
+        SplitJob& s = splits[j.id];
+        s.job = j;
+        s.chunks = chunks;
+        s.left = chunks;
+        int base = j.pages / chunks, extra = j.pages % chunks, page = 1;
+        for (int k = 0; k < chunks; ++k) {
+            PrintJob c = j;
+            c.id = j.id + 1 + k;
+            c.pages = base + (k < extra ? 1 : 0);
+            c.parent = j.id;
+            c.firstPage = page;
+            page += c.pages;
+            put(c);
+        }
+    }
+
+    // 设置拆分阈值（页）；只影响此后提交的任务
+    void setSplitPages(int pages) {
+        splitPages = std::max(0, pages);
+        logEvent("K," + timeText(currentTime) + "," + std::to_string(splitPages));
+    }
+
+    // 拆分任务（母任务或任一段的 ID）的母任务 ID；不是拆分任务时返回 0
+    int splitRoot(int id) const {
+        if (splits.count(id)) return id;
+        const PrintJob* j = findWaiting(id);
+        if (!j) {
+            auto h = held.find(id);
+            if (h != held.end()) j = &h->second;
+        }
+        if (!j) {
+            for (const auto& p : printers) {
+                if (p.busy && p.current.id == id) j = &p.current;
+            }
+        }
+        return j && splits.count(j->parent) ? j->parent : 0;
+    }
+
+    // ========== 准入控制 ==========
+
+    // 设置准入策略和等待队列长度上限（0 为不限）；只影响此后的提交
+    void setAdmission(AdmissionPolicy a, int limit) {
+        admission = a;
+        queueLimit = std::max(0, limit);
+        logEvent("L," + timeText(currentTime) + "," + std::to_string((int)a) + "," + std::to_string(queueLimit));
+    }
+
+    // 按当前积压估算 pages 页的新任务在 arrive 时刻到达后的完成时刻。
+    // 全部打印机合起来每秒打 Σ 1/secPerPage 页，等待队列（waitQ.pages 随增删维护）和打印机上
+    // 未打完的页先打完、新任务排在最后（按到达顺序的保守估计，不看优先级），
+    // 之后它（拆分后的一段）在最快的打印机上单独打完——一个任务只能在一台打印机上打。
+    // 与队列长度无关，只按打印机台数循环一次。extraPages 为尚未入队、但应计入积压的页数
+    SimTime predictFinish(int pages, SimTime arrive, long long extraPages = 0) const {
+        double rate = 0.0, fastest = 0.0;
+        double backlog = (double)(waitQ.pages + extraPages);
+        for (const auto& p : printers) {
+            rate += 1.0 / p.secPerPage;
+            if (fastest == 0.0 || p.secPerPage < fastest) fastest = p.secPerPage;
+            if (p.busy) backlog += p.pagesUnfinished();
+        }
+        int chunks = chunksFor(pages);
+        double alone = (double)((pages + chunks - 1) / chunks) * fastest;
+        return std::max(currentTime + secToTime(backlog / rate), arrive) + secToTime(alone);
+    }
+
+    // 准入判断：等待队列已满时拒绝；有截止时刻、预计赶不上的任务按 admission 拒绝或降级。
+    // 在任务到达（进入等待队列）时进行：立即提交的任务在提交时，预约任务在 admitArrivals 中。
+    // extraPages / extraJobs 为尚未入队、但应计入积压和队列长度的页数与任务数
+    enum class Verdict { Accept, Reject, Demote };
+    Verdict judge(const PrintJob& j, long long extraPages = 0, size_t extraJobs = 0) const {
+        if (queueLimit > 0 && waitQ.size() + extraJobs >= (size_t)queueLimit) return Verdict::Reject;
+        if (admission == AdmissionPolicy::Off || j.deadline < 0) return Verdict::Accept;
+        if (predictFinish(j.pages, j.submitTime, extraPages) <= j.deadline) return Verdict::Accept;
+        return admission == AdmissionPolicy::Reject ? Verdict::Reject : Verdict::Demote;
+    }
+
+    // 立即提交的任务：被拒绝时不分配 ID、不写日志；降级直接改写优先级
+    bool admit(PrintJob& j, long long extraPages = 0, size_t extraJobs = 0) {
+        Verdict v = judge(j, extraPages, extraJobs);
+        if (v == Verdict::Reject) {
+            rejectCount++;
+            return false;
+        }
+        if (v == Verdict::Demote) {
+            j.priority = kDemotedPriority;
+            demoteCount++;
+        }
+        return true;
+    }
+
+    // 把已在等待队列中的任务（拆分任务为全部分段）降到最低优先级：出队、改写、重新入队
+    void demoteJob(int id) {
+        auto s = splits.find(id);
+        if (s == splits.end()) return demoteOne(id);
+        s->second.job.priority = kDemotedPriority;
+        for (int c = id + 1; c <= id + s->second.chunks; ++c) demoteOne(c);
+    }
+
+    void demoteOne(int id) {
+        PrintJob j;
+        if (!removeWaiting(id, &j)) return;
+        j.priority = kDemotedPriority;
+        waitQ.push(std::move(j));
+    }
+
+    // 追加任务：入队。deadline 为截止时刻（绝对时刻，-1 为没有）；被准入控制拒绝时返回 0
+    int addJob(std::string_view user, std::string_view doc, int pages, int priority = 0, SimTime deadline = -1) {
+        StringPool& strings = StringPool::global();
+        return addJob(strings.internUser(user), strings.addDoc(doc), pages, priority, deadline);
+    }
+
+    // 用户名、文档名已在字符串池中（批量仿真复用同一份负载时不再重复写入字节区）
+    int addJob(UserId user, DocRef doc, int pages, int priority = 0, SimTime deadline = -1) {
         PrintJob j;
-        j.id = nextId++;
         j.user = user;
         j.doc = doc;
         j.pages = pages;
+        j.priority = priority;
         j.submitTime = currentTime;
-        waitQ.push(j);
-        saveWaiting();
+        j.deadline = deadline;
+        if (!admit(j)) return 0;
+        int chunks = chunksFor(pages);
+        j.id = takeIds(idsFor(chunks));
+        enqueue(j, chunks, [this](const PrintJob& x) { waitQ.push(x); });
+        logAdd(j, chunks);
         return j.id;
     }
 
-    // 取消等待中的任务（按 ID），返回是否找到并删除
-    bool cancelJob(int id) {
-        bool found = false;
-        std::queue<PrintJob> q2;
-        while (!waitQ.empty()) {
-            auto x = waitQ.front(); waitQ.pop();
-            if (x.id == id) {
-                found = true;
-            } else {
-                q2.push(x);
+    // 批量添加：分配连续的 ID 区间 [返回值, 返回值 + n)（有任务被拆分时各段的 ID 插在其母任务之后，
+    // 之后的任务依次后移；提交时即被准入控制拒绝的任务不占 ID），等待队列一次预留容量、整体移入，
+    // 日志只同步一次。提交时刻已到的任务按当前时刻入队，其余作为预约任务。n 为 0 时返回 nextId
+    int addJobs(const JobSpec* specs, size_t n) {
+        if (n == 0) return nextId;
+        std::vector<PrintJob> jobs(n);
+        long long batchPages = 0;   // 本批已接收、尚未入队的页数和任务数，计入后面任务的积压
+        size_t batchJobs = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const JobSpec& s = specs[i];
+            PrintJob& j = jobs[i];
+            j.user = s.user;
+            j.doc = s.doc;
+            j.pages = s.pages;
+            j.priority = s.priority;
+            j.submitTime = std::max(s.submitTime, currentTime);
+            j.deadline = s.deadline;
+            if (j.submitTime <= currentTime) {   // 预约任务到达时才做准入判断
+                if (!admit(j, batchPages, batchJobs)) continue;
+                batchPages += j.pages;
+                batchJobs++;
             }
+            j.id = 0;   // 已接收
         }
-        waitQ.swap(q2);
-        saveWaiting();
+        int total = 0;
+        for (const auto& j : jobs) total += j.id == 0 ? idsFor(chunksFor(j.pages)) : 0;
+        int first = takeIds(total);
+        int id = first;
+        std::vector<PrintJob> due;
+        due.reserve(batchJobs);
+        auto put = [this, &due](const PrintJob& x) {
+            if (x.submitTime > currentTime) pending.push(x);
+            else due.push_back(x);
+        };
+        beginBatch();
+        for (PrintJob& j : jobs) {
+            if (j.id != 0) continue;
+            int chunks = chunksFor(j.pages);
+            j.id = id;
+            id += idsFor(chunks);
+            logAdd(j, chunks);
+            enqueue(j, chunks, put);
+        }
+        waitQ.pushRange(std::make_move_iterator(due.begin()), std::make_move_iterator(due.end()));
+        endBatch();
+        return first;
+    }
+    int addJobs(const std::vector<JobSpec>& specs) {
+        return addJobs(specs.data(), specs.size());
+    }
+
+    // 分配 n 个连续的 ID，返回第一个。没有共享分配器时就是 nextId；
+    // 有时先从本实例手里的块里分，不够再领一块（n 超过一块时单独领取一段）
+    int takeIds(int n) {
+        int first;
+        if (!idAlloc) {
+            first = nextId;
+        } else if (n <= idBlockEnd - idBlockNext) {
+            first = idBlockNext;
+            idBlockNext += n;
+        } else if (n >= IdAllocator::kBlock) {
+            first = idAlloc->reserve(n);
+        } else {
+            idBlockNext = idAlloc->reserve(IdAllocator::kBlock);
+            idBlockEnd = idBlockNext + IdAllocator::kBlock;
+            first = idBlockNext;
+            idBlockNext += n;
+        }
+        nextId = std::max(nextId, first + n);
+        return first;
+    }
+
+    // 从等待队列中移除指定 ID；out 非空时返回被移除的任务
+    bool removeWaiting(int id, PrintJob* out = nullptr) {
+        return waitQ.remove(id, out);
+    }
+
+    // 取消任务（按 ID）：等待中、已暂停和正在打印的任务都可以取消，返回是否找到并删除。
+    // 正在打印的任务已打完的页计入打印机的统计，打印机在下一次推进时接着取下一个任务
+    bool cancelJob(int id) {
+        bool found = removeJob(id);
+        if (found) logEvent("C," + std::to_string(id) + "," + timeText(currentTime));
         return found;
     }
 
-    // 设置速度：秒/页（支持小数，限定 > 0）
+    // 批量取消（按 ID 列表），返回实际取消的数量；日志只同步一次
+    size_t cancelJobs(const std::vector<int>& ids) {
+        size_t n = 0;
+        beginBatch();
+        for (int id : ids) n += cancelJob(id) ? 1 : 0;
+        endBatch();
+        return n;
+    }
+
+    // 取消等待队列中所有满足 pred(const PrintJob&) 的任务，返回取消的数量（不涉及正在打印和已暂停的任务）。
+    // 队列整体扫描一次、重建一次堆，日志只同步一次。有分段被取消的拆分任务整个取消，按一个计
+    template <typename Pred>
+    size_t cancelJobsIf(Pred&& pred) {
+        std::vector<int> ids, parents;
+        waitQ.removeIf([&](const PrintJob& j) {
+            if (!pred(j)) return false;
+            (j.parent ? parents : ids).push_back(j.parent ? j.parent : j.id);
+            return true;
+        });
+        std::sort(parents.begin(), parents.end());
+        parents.erase(std::unique(parents.begin(), parents.end()), parents.end());
+        for (int id : parents) {   // 其余分段可能在打印或已暂停
+            removeJob(id);
+            splits.erase(id);
+            ids.push_back(id);
+        }
+        beginBatch();
+        std::string t = timeText(currentTime);
+        for (int id : ids) logEvent("C," + std::to_string(id) + "," + t);
+        endBatch();
+        return ids.size();
+    }
+
+    // 取消某个用户在等待队列中的全部任务
+    size_t cancelUserJobs(std::string_view user) {
+        UserId u = StringPool::global().findUser(user);
+        if (u == 0 && !user.empty()) return 0;   // 从未出现过的用户名
+        return cancelJobsIf([u](const PrintJob& j) { return j.user == u; });
+    }
+
+    // ========== 正在打印的任务：暂停、恢复、抢占 ==========
+
+    // 暂停任务：等待中的任务移出队列；正在打印的任务立即让出打印机，已打完的页保留，
+    // 打到一半的那一页恢复后重打。返回是否找到
+    bool pauseJob(int id) {
+        bool found = holdJob(id);
+        if (found) logEvent("H," + std::to_string(id) + "," + timeText(currentTime));
+        return found;
+    }
+
+    // 恢复已暂停的任务：带着剩余页数回到等待队列，按出队规则重新排队
+    bool resumeJob(int id) {
+        bool found = releaseJob(id);
+        if (found) logEvent("U," + std::to_string(id) + "," + timeText(currentTime));
+        return found;
+    }
+
+    // 开关抢占（只影响此后的调度，正在打印的任务不会立即被打断）
+    void setPreemption(bool on) {
+        preempt = on;
+        logEvent("E," + timeText(currentTime) + "," + (on ? "1" : "0"));
+    }
+
+    Printer* printerOf(int id) {
+        for (auto& p : printers) {
+            if (p.busy && p.current.id == id) return &p;
+        }
+        return nullptr;
+    }
+
+    // 以下三个只改状态、不写日志（重放日志时同样调用）。
+    // 取消拆分任务的母任务或任一段都取消整个任务；暂停、恢复母任务作用于它的全部分段，
+    // 作用于某一段时只影响该段
+    bool removeJob(int id) {
+        int root = splitRoot(id);
+        if (root == 0) return removeOne(id);
+        int chunks = splits[root].chunks;
+        bool found = false;
+        for (int c = root + 1; c <= root + chunks; ++c) found |= removeOne(c);
+        if (found) splits.erase(root);   // 尚未到达的预约任务不能取消
+        return found;
+    }
+
+    bool holdJob(int id) {
+        auto s = splits.find(id);
+        if (s == splits.end()) return holdOne(id);
+        bool found = false;
+        for (int c = id + 1; c <= id + s->second.chunks; ++c) found |= holdOne(c);
+        return found;
+    }
+
+    bool releaseJob(int id) {
+        auto s = splits.find(id);
+        if (s == splits.end()) return releaseOne(id);
+        bool found = false;
+        for (int c = id + 1; c <= id + s->second.chunks; ++c) found |= releaseOne(c);
+        return found;
+    }
+
+    bool removeOne(int id) {
+        if (removeWaiting(id) || held.erase(id) > 0) return true;
+        Printer* p = printerOf(id);
+        if (!p) return false;
+        takeOff(*p);
+        return true;
+    }
+
+    bool holdOne(int id) {
+        PrintJob j;
+        if (!removeWaiting(id, &j)) {
+            Printer* p = printerOf(id);
+            if (!p) return false;
+            j = takeOff(*p);
+        }
+        held[id] = j;
+        return true;
+    }
+
+    bool releaseOne(int id) {
+        auto it = held.find(id);
+        if (it == held.end()) return false;
+        waitQ.push(it->second);
+        held.erase(it);
+        return true;
+    }
+
+    // 把任务从打印机上撤下并返回：已打完的整页记入任务（donePages）和打印机，打印机变为空闲。
+    // 与等待中的任务一样，不再计入该用户的占用页数
+    PrintJob takeOff(Printer& p) {
+        PrintJob j = p.current;
+        int printed = p.pagesPrinted();
+        p.pagesDone += printed - j.donePages;
+        auto it = userPages.find(j.user);
+        if (it != userPages.end() && (it->second -= j.pages) <= 0) userPages.erase(it);
+        j.donePages = printed;
+        p.current = PrintJob();
+        p.busy = false;
+        p.remain = 0;
+        return j;
+    }
+
+    // 正在打印的任务按实时剩余页数参与比较（SRPT）。
+    // 用户公平策略不按队首出队，让出的打印机未必交给压过它的任务，因此不抢占
+    bool outranked(const Printer& p) const {
+        if (!p.busy || waitQ.empty() || policy == DispatchPolicy::FairShare) return false;
+        PrintJob cur = p.current;
+        cur.donePages = p.pagesPrinted();
+        return waitQ.outranks(waitQ.front(), cur);
+    }
+
+    // 恰在页边界上、且被等待队列队首压过的打印机让出当前任务，队首随即开始打印。
+    // 每次抢占都换上一个严格更靠前的任务，因此同一时刻不会来回抢占
+    void preemptAtPageEnd() {
+        for (auto& p : printers) {
+            if (p.toPageEnd() > 2 || !outranked(p)) continue;
+            int id = p.current.id;
+            waitQ.push(takeOff(p));
+            preemptCount++;
+            logEvent("R," + std::to_string(id) + "," + timeText(currentTime) + "," + std::to_string(p.id));
+            dispatch();
+        }
+    }
+
+    // 设置速度：秒/页（支持小数，限定 > 0），作用于所有打印机；
+    // 正在打印的任务剩余的页数按新速度打印
     void setSpeed(double sec_per_page) {
         if (sec_per_page <= 0) sec_per_page = 0.001;
         secPerPage = sec_per_page;
+        for (auto& p : printers) p.setSpeed(secPerPage);
+        std::ostringstream ss;
+        ss << "V," << timeText(currentTime) << "," << std::setprecision(17) << secPerPage;
+        logEvent(ss.str());
     }
 
-    // 每秒推进 dt（离散仿真主循环的一步）
-    void tick(int dt = 1) {
-        for (int step = 0; step < dt; ++step) {
-            if (!busy) {
-                if (!waitQ.empty()) {
-                    current = waitQ.front(); waitQ.pop();
-                    current.startTime = currentTime;
-                    remainSec = (int)std::ceil(current.pages * secPerPage);
-                    busy = true;
-                    saveWaiting();
-                    saveRunning();
-                } else {
-                    currentTime++;
-                    continue;
-                }
+    // 单独设置某台打印机的速度（同样作用于正在打印的任务的剩余页数）
+    bool setPrinterSpeed(int printer, double sec_per_page) {
+        if (printer < 0 || (size_t)printer >= printers.size()) return false;
+        if (sec_per_page <= 0) sec_per_page = 0.001;
+        printers[printer].setSpeed(sec_per_page);
+        std::ostringstream ss;
+        ss << "P," << timeText(currentTime) << "," << printer << "," << std::setprecision(17) << sec_per_page;
+        logEvent(ss.str());
+        return true;
+    }
+
+    // 调整打印机数量。缩减时只移除末尾的空闲打印机，返回实际数量
+    int setPrinterCount(int n) {
+        int before = (int)printers.size();
+        resizePool(n);
+        if ((int)printers.size() != before) {
+            logEvent("N," + timeText(currentTime) + "," + std::to_string(printers.size()));
+        }
+        return (int)printers.size();
+    }
+
+    void setPolicy(DispatchPolicy p) {
+        policy = p;
+        applyDiscipline();
+        logEvent("D," + timeText(currentTime) + "," + std::to_string((int)p));
+    }
+
+    // 设置等待队列出队规则；rate 为 AgingPriority 每等待 1 秒提升的优先级
+    void setDiscipline(QueueDiscipline d, double rate) {
+        discipline = d;
+        agingRate = rate;
+        applyDiscipline();
+        std::ostringstream ss;
+        ss << "Q," << timeText(currentTime) << "," << (int)d << "," << std::setprecision(17) << rate;
+        logEvent(ss.str());
+    }
+    void setDiscipline(QueueDiscipline d) {
+        setDiscipline(d, agingRate);
+    }
+
+    // 短作业优先策略就是按页数出队，直接复用队列的堆。
+    // 队列按 submitTime 的单位（微秒）计算老化，速率相应换算
+    void applyDiscipline() {
+        QueueDiscipline d = policy == DispatchPolicy::ShortestJobFirst
+                          ? QueueDiscipline::ShortestJob : discipline;
+        double rate = agingRate / kTicksPerSec;
+        if (d != waitQ.discipline || rate != waitQ.agingRate) waitQ.setDiscipline(d, rate);
+    }
+
+    void resizePool(int n) {
+        if (n < 1) n = 1;
+        while ((int)printers.size() > n && !printers.back().busy) printers.pop_back();
+        while ((int)printers.size() < n) {
+            Printer p;
+            p.id = (int)printers.size();
+            p.secPerPage = secPerPage;
+            printers.push_back(p);
+        }
+    }
+
+    int busyCount() const {
+        int n = 0;
+        for (const auto& p : printers) n += p.busy ? 1 : 0;
+        return n;
+    }
+
+    // 预约任务：在未来时刻 submitTime 到达（到达前不进入等待队列）。
+    // 准入判断在到达时按那时的积压进行（见 admitArrivals），因此这里总是分配 ID
+    int addJobAt(std::string_view user, std::string_view doc, int pages, SimTime submitTime,
+                 int priority = 0, SimTime deadline = -1) {
+        StringPool& strings = StringPool::global();
+        return addJobAt(strings.internUser(user), strings.addDoc(doc), pages, submitTime, priority, deadline);
+    }
+
+    int addJobAt(UserId user, DocRef doc, int pages, SimTime submitTime, int priority = 0,
+                 SimTime deadline = -1) {
+        if (submitTime <= currentTime) return addJob(user, doc, pages, priority, deadline);
+        PrintJob j;
+        j.user = user;
+        j.doc = doc;
+        j.pages = pages;
+        j.priority = priority;
+        j.submitTime = submitTime;
+        j.deadline = deadline;
+        int chunks = chunksFor(pages);
+        j.id = takeIds(idsFor(chunks));
+        enqueue(j, chunks, [this](const PrintJob& x) { pending.push(x); });
+        logAdd(j, chunks);
+        return j.id;
+    }
+
+    // 接上流式任务源（替换之前的源）；提交时刻已到的任务立即入队
+    void setSource(std::function<bool(JobSpec&)> src) {
+        source = std::move(src);
+        hasSourceHead = false;
+        pullSource();
+    }
+
+    // 从源里取任务，直到取出一个尚未到达的任务或源耗尽
+    void pullSource() {
+        while (source && !hasSourceHead) {
+            if (!source(sourceHead)) {
+                source = nullptr;
+                break;
+            }
+            const JobSpec& s = sourceHead;
+            if (s.submitTime > currentTime) hasSourceHead = true;
+            else addJob(s.user, s.doc, s.pages, s.priority, s.deadline);
+        }
+    }
+
+    // 推进 dt 秒，可带小数（离散事件仿真：时钟直接跳到下一个完成/到达事件）
+    void tick(double dt = 1) {
+        SimTime d = secToTime(dt);
+        if (d <= 0) return;
+        advance(currentTime + d, false);
+    }
+
+    // 一直跑到队列清空、当前任务完成且没有待到达的任务
+    void runToEnd() {
+        advance(LLONG_MAX, true);
+    }
+
+    // 最多处理 maxEvents 个事件后返回，已跑完时返回 true；
+    // 供后台线程分段执行 runToEnd，段与段之间可以处理新命令或中止
+    bool runFor(long long maxEvents) {
+        advance(LLONG_MAX, true, maxEvents);
+        return idle();
+    }
+
+    // 已暂停的任务不会自己前进，不算在内
+    bool idle() const {
+        return busyCount() == 0 && waitQ.empty() && pending.empty() && !hasSourceHead;
+    }
+
+    // —— 事件驱动主循环
+    // 任务在打印机空闲且时钟 < limit 时于当前时刻开始，按 pages * secPerPage 精确到微秒
+    // 的时长打印（中途换速度只影响剩余页数）；下一个任务在完成时刻紧接着开始。
+    // 每次循环只处理一个事件，因此代价为 O(任务数) 而不是 O(仿真时长)。
+    void advance(SimTime limit, bool drain, long long maxEvents = LLONG_MAX) {
+        metrics::ScopedTimer timer(metricsOn() ? &metrics->advanceLatency : nullptr);
+        uint64_t wall0 = metricsOn() ? metrics::nowNs() : 0;
+        SimTime sim0 = currentTime;
+        unsigned long long events0 = eventsLogged;
+        size_t pending0 = pending.size();
+        long long steps = 0;
+        for (;; ++steps) {
+            admitArrivals();
+            if (currentTime < limit) {
+                dispatch();
+                if (preempt) preemptAtPageEnd();
+            }
+            if (drain && idle()) break;
+            if (currentTime >= limit || steps >= maxEvents) break;
+
+            SimTime next = limit;
+            for (const auto& p : printers) {
+                if (!p.busy) continue;
+                next = std::min(next, currentTime + p.remain);
+                // 会被抢占的任务：下一个事件是这一页打完
+                if (preempt && outranked(p)) next = std::min(next, currentTime + std::max<SimTime>(1, p.toPageEnd()));
+            }
+            if (!pending.empty()) next = std::min(next, pending.top().submitTime);
+            if (hasSourceHead) next = std::min(next, sourceHead.submitTime);
+
+            SimTime dt = next - currentTime;
+            currentTime = next;
+            for (auto& p : printers) {
+                if (!p.busy) continue;
+                p.remain -= dt;
+                p.busyTime += dt;
+            }
+            // 先推进全部打印机再处理完成事件：完成事件可能触发快照，快照必须看到一致的状态
+            for (auto& p : printers) {
+                if (p.busy && p.remain <= 0) finishOn(p);
+            }
+        }
+        admitArrivals();
+        done.trim(currentTime);
+        // 时钟只在处理过事件（含预约任务到达）或跨过整 clockLogEvery 时记一条：实时模式空闲时
+        // 每帧都会调用，逐帧记日志会让日志不断增长并触发快照。
+        // 恢复时最多少走一段没有任何事件的时间（不超过 clockLogEvery），状态仍是那一时刻的状态
+        bool crossed = clockLogEvery > 0 && currentTime / clockLogEvery != sim0 / clockLogEvery;
+        if (eventsLogged != events0 || pending.size() != pending0 || crossed) logEvent("T," + timeText(currentTime));
+        if (metricsOn()) {
+            uint64_t wall = metrics::nowNs() - wall0;
+            SimTime sim = currentTime - sim0;
+            metrics->advanceCalls.add();
+            metrics->events.add((uint64_t)steps);
+            metrics->simMicros.add((uint64_t)sim);
+            metrics->advanceWallNs.add(wall);
+            if (wall > 0 && sim > 0) metrics->simSpeedup.set(timeToSec(sim) / ((double)wall * 1e-9));
+            publishMetrics();
+        }
+    }
+
+    // ========== 运行时指标 ==========
+    // 编译期关闭时 kMetricsEnabled 为常量 false，所有埋点连同取时钟一起被消去
+    bool metricsOn() const {
+        return kMetricsEnabled && metrics != nullptr;
+    }
+
+    // 刷新瞬时值和累计字节数（advance 结束时自动调用，也可在界面刷新前调用）
+    void publishMetrics() const {
+        if (!metricsOn()) return;
+        metrics->simTime.set(timeToSec(currentTime));
+        metrics->queueDepth.set((double)waitQ.size());
+        metrics->pendingDepth.set((double)pending.size());
+        metrics->busyPrinters.set((double)busyCount());
+        metrics->doneTotal.set((double)doneStats.wait.n);
+        metrics->journalBytes.set(journal.bytesWritten);
+        metrics->snapshotBytes.set(snapshotBytes);
+        metrics->doneLogBytes.set(doneLog.bytesWritten);
+        metrics->preemptions.set((uint64_t)preemptCount);
+        metrics->rejected.set((uint64_t)rejectCount);
+        metrics->demoted.set((uint64_t)demoteCount);
+    }
+
+    // 把提交时刻已到的预约任务移入等待队列（由时钟决定，无需记日志）；
+    // 源的任务到达时提交，再接着取下一个。
+    // 准入控制开启时，同一时刻到达的任务先按入队前的积压逐个判断，全部入队后再移出被拒绝的、
+    // 降级被降级的，并各记一条 M 事件；重放时 check 为 false，只入队，判断结果由 M 事件还原
+    // （两边的入队、移出顺序相同，等待队列因此一致）
+    void admitArrivals(bool check = true) {
+        bool judging = check && (queueLimit > 0 || admission != AdmissionPolicy::Off);
+        std::vector<std::pair<int, Verdict>> verdicts;
+        long long extraPages = 0;
+        size_t extraJobs = 0;
+        int lastRoot = 0;
+        std::vector<PrintJob> due;
+        while (!pending.empty() && pending.top().submitTime <= currentTime) {
+            due.push_back(pending.top());
+            pending.pop();
+        }
+        // 先全部判断（积压只含入队前的等待队列，加上本批中在前面且被接收的任务），再全部入队
+        for (const PrintJob& top : due) {
+            int root = top.parent ? top.parent : top.id;
+            if (!judging || root == lastRoot) continue;   // 拆分任务的各段 ID 相邻、同时到达，按母任务判断一次
+            lastRoot = root;
+            auto s = splits.find(root);
+            const PrintJob& j = s != splits.end() ? s->second.job : top;
+            Verdict v = judge(j, extraPages, extraJobs);
+            if (v != Verdict::Reject) {
+                extraPages += j.pages;
+                extraJobs++;
+            }
+            if (v != Verdict::Accept) verdicts.emplace_back(root, v);
+        }
+        for (PrintJob& j : due) waitQ.push(std::move(j));
+        for (const auto& [id, v] : verdicts) {
+            if (v == Verdict::Reject) {
+                removeJob(id);
+                rejectCount++;
             } else {
-                saveRunning();
+                demoteJob(id);
+                demoteCount++;
             }
+            logEvent("M," + std::to_string(id) + "," + timeText(currentTime) + "," + (v == Verdict::Reject ? "0" : "1"));
+        }
+        if (hasSourceHead && sourceHead.submitTime <= currentTime) {
+            hasSourceHead = false;
+            const JobSpec& s = sourceHead;
+            addJob(s.user, s.doc, s.pages, s.priority, s.deadline);
+            pullSource();
+        }
+    }
 
-            remainSec--;
-            currentTime++;
-            if (remainSec <= 0) {
-                current.finishTime = currentTime;
-                done.push_back(current);
-                busy = false;
-                saveRunning();
-                saveDone();
+    // 按调度策略把等待任务分配给空闲打印机
+    void dispatch() {
+        while (!waitQ.empty()) {
+            int pi = pickPrinter();
+            if (pi < 0) return;
+            int id = pickJob();
+            PrintJob j;
+            waitQ.remove(id, &j);
+            startOn(printers[pi], std::move(j));
+        }
+    }
+
+    int pickPrinter() const {
+        int best = -1;
+        for (size_t i = 0; i < printers.size(); ++i) {
+            if (printers[i].busy) continue;
+            if (policy != DispatchPolicy::LeastLoaded) return (int)i;
+            if (best < 0 || printers[i].busyTime < printers[best].busyTime) best = (int)i;
+        }
+        return best;
+    }
+
+    // 返回下一个要打印的任务 ID（等待队列非空）。除用户公平外都由队列的出队规则决定
+    int pickJob() const {
+        const PrintJob* pick = &waitQ.front();
+        if (policy == DispatchPolicy::FairShare) {
+            auto usage = [this](const PrintJob& j) {
+                auto it = userPages.find(j.user);
+                return it == userPages.end() ? 0LL : it->second;
+            };
+            long long best = usage(*pick);
+            for (const auto& j : waitQ) {
+                long long u = usage(j);
+                if (u < best) { best = u; pick = &j; }
             }
         }
+        return pick->id;
     }
 
-    // 一直跑到队列清空且当前任务完成
-    void runToEnd() {
-        while (busy || !waitQ.empty()) {
-            tick(1);
+    // 被抢占、暂停过的任务接着打剩余页数，开始时刻保留第一次开始的时刻
+    void startOn(Printer& p, PrintJob j) {
+        p.current = std::move(j);
+        if (p.current.startTime < 0) p.current.startTime = currentTime;
+        p.remain = p.printTime(p.current.remainingPages());
+        p.busy = true;
+        userPages[p.current.user] += p.current.pages;
+        logEvent("S," + std::to_string(p.current.id) + "," + timeText(currentTime) + ","
+                 + timeText(p.remain) + "," + std::to_string(p.id));
+    }
+
+    void finishOn(Printer& p) {
+        int id = p.current.id;
+        complete(p);
+        logEvent("F," + std::to_string(id) + "," + timeText(currentTime) + ","
+                 + std::to_string(p.id));
+    }
+
+    // 打印机上的任务打完（重放日志时同样调用）。分段各自记一条完成记录，
+    // 最后一段完成时母任务以最早开始、最晚完成的时刻记入完成记录和统计
+    void complete(Printer& p) {
+        PrintJob& j = p.current;
+        j.finishTime = currentTime;
+        p.jobsDone++;
+        p.pagesDone += j.remainingPages();
+        recordDone(j);
+        auto it = j.parent ? splits.find(j.parent) : splits.end();
+        if (it != splits.end()) {
+            auto u = userPages.find(j.user);   // 分段的页数改由母任务计入
+            if (u != userPages.end() && (u->second -= j.pages) <= 0) userPages.erase(u);
+            PrintJob& m = it->second.job;
+            if (m.startTime < 0 || j.startTime < m.startTime) m.startTime = j.startTime;
+            m.finishTime = std::max(m.finishTime, currentTime);
+            if (--it->second.left <= 0) {
+                userPages[m.user] += m.pages;
+                recordDone(m);
+                splits.erase(it);
+            }
+        }
+        p.current = PrintJob();
+        p.busy = false;
+        p.remain = 0;
+    }
+
+    // 记入完成记录和增量统计；archive 时同时追加到二进制完成日志。
+    // 分段只留完成记录，统计按母任务计
+    void recordDone(const PrintJob& j, bool archive = true) {
+        if (j.parent == 0) countDone(j);
+        done.push(j);
+        if (archive && persist) doneLog.append(j);
+    }
+
+    void countDone(const PrintJob& j) {
+        doneStats.add(j.user, j.pages, j.waitSec(), j.durationSec());
+        if (j.deadline >= 0) doneStats.addDeadline(j.latenessSec());
+    }
+
+    // ========== 完成记录查询 ==========
+    // 热数据窗口内走内存索引；已逐出的记录（持久化开启时）从 done.bin 读取，
+    // 按 ID/时间查询时用块头的最小/最大值整块跳过。结果按完成顺序排列。
+    // 从文件读出的文档名第一次用到时复制进字符串池，重复查询不会再增长。
+
+    bool findDone(int id, PrintJob* out = nullptr) {
+        if (const PrintJob* j = done.findId(id)) {
+            if (out) *out = *j;
+            return true;
+        }
+        donelog::BlockView v;
+        uint32_t r = 0;
+        if (!openCold() || !coldLog.findId(id, v, r, done.first())) return false;
+        if (out) *out = coldJob(v, r);
+        return true;
+    }
+
+    // limit 为最多返回的条数（取最早的 limit 条）
+    std::vector<PrintJob> doneByUser(std::string_view user, size_t limit = SIZE_MAX) {
+        std::vector<PrintJob> out;
+        if (openCold()) {
+            coldLog.forUser(user, [&](const donelog::BlockView& v, uint32_t r) {
+                if (out.size() < limit) out.push_back(coldJob(v, r));
+            }, done.first());
+        }
+        UserId id = StringPool::global().findUser(user);
+        if (id != 0 || user.empty()) {
+            done.forUser(id, [&](const PrintJob& j) {
+                if (out.size() < limit) out.push_back(j);
+            });
+        }
+        return out;
+    }
+
+    std::vector<PrintJob> doneBetween(SimTime t1, SimTime t2, size_t limit = SIZE_MAX) {
+        std::vector<PrintJob> out;
+        if (openCold()) {
+            coldLog.finishedBetween(t1, t2, [&](const donelog::BlockView& v, uint32_t r) {
+                if (out.size() < limit) out.push_back(coldJob(v, r));
+            }, done.first());
+        }
+        done.finishedBetween(t1, t2, [&](const PrintJob& j) {
+            if (out.size() < limit) out.push_back(j);
+        });
+        return out;
+    }
+
+    // 按完成顺序遍历全部完成记录（导出用）
+    template <typename F>
+    void forEachDone(F&& fn) {
+        if (openCold()) {
+            coldLog.finishedBetween(LLONG_MIN, LLONG_MAX, [&](const donelog::BlockView& v, uint32_t r) {
+                fn(coldJob(v, r));
+            }, done.first());
+        }
+        for (const auto& j : done) fn(j);
+    }
+
+    // 映射 done.bin 以读取已逐出的记录；没有可读的记录时返回 false。
+    // 持久化关闭时逐出的记录已丢弃，只查内存
+    bool openCold() {
+        if (!persist || done.first() == 0) return false;
+        if (coldLog.rows() < done.first()) {
+            doneLog.flush(false);   // 最后一块可能还只在内存里
+            coldLog.open(doneLog.path, doneLog.stringsPath);
+        }
+        return coldLog.rows() > 0;
+    }
+
+    PrintJob coldJob(const donelog::BlockView& v, uint32_t r) {
+        StringPool& strings = StringPool::global();
+        PrintJob j;
+        j.id         = v.id[r];
+        j.user       = strings.internUser(coldLog.string(v.user[r]));
+        auto it = coldDocs.find(v.doc[r]);
+        if (it == coldDocs.end()) {
+            it = coldDocs.emplace(v.doc[r], strings.addDoc(coldLog.string(v.doc[r]))).first;
         }
+        j.doc        = it->second;
+        j.pages      = v.pages[r];
+        j.priority   = v.priority[r];
+        j.submitTime = v.submitTime[r];
+        j.startTime  = v.startTime[r];
+        j.finishTime = v.finishTime[r];
+        j.parent     = v.parent[r];
+        j.firstPage  = v.firstPage[r];
+        j.deadline   = v.deadline[r];
+        return j;
     }
 
-    // 获取等待队列的副本（用于显示）
+    // 获取等待队列的副本（按出队顺序，用于显示）；只需遍历时直接 for (const auto& j : waitQ)
     std::vector<PrintJob> getWaitingJobs() const {
-        std::vector<PrintJob> result;
-        std::queue<PrintJob> tmp = waitQ;
-        while (!tmp.empty()) {
-            result.push_back(tmp.front());
-            tmp.pop();
+        return waitQ.ordered();
+    }
+
+    const PrintJob* findWaiting(int id) const {
+        return waitQ.find(id);
+    }
+
+    // 任务当前所处的位置；预约中（尚未到达）、已取消或不存在的任务返回 Unknown
+    enum class JobState { Unknown = 0, Waiting, Printing, Done, Paused };
+
+    // 拆分任务的母任务：有段在打印即为打印中，否则有段在排队即为等待，否则为暂停；
+    // 开始时刻取各段中最早的
+    JobState findJob(int id, PrintJob* out = nullptr) {
+        auto s = splits.find(id);
+        if (s != splits.end()) {
+            PrintJob m = s->second.job;
+            bool seen[5] = {};
+            for (int c = id + 1; c <= id + s->second.chunks; ++c) {
+                PrintJob j;
+                JobState cs = findChunk(c, j);
+                seen[(int)cs] = true;
+                if (j.startTime >= 0 && (m.startTime < 0 || j.startTime < m.startTime)) m.startTime = j.startTime;
+            }
+            JobState state = seen[(int)JobState::Printing] ? JobState::Printing
+                           : seen[(int)JobState::Waiting]  ? JobState::Waiting
+                           : seen[(int)JobState::Paused]   ? JobState::Paused : JobState::Unknown;
+            if (state != JobState::Unknown && out) *out = m;
+            return state;
         }
-        return result;
+        PrintJob j;
+        JobState state = findChunk(id, j);
+        if (state != JobState::Unknown) {
+            if (out) *out = j;
+            return state;
+        }
+        return findDone(id, out) ? JobState::Done : JobState::Unknown;
+    }
+
+    // 等待、暂停或打印中的单个任务（含分段）
+    JobState findChunk(int id, PrintJob& out) const {
+        if (const PrintJob* j = findWaiting(id)) {
+            out = *j;
+            return JobState::Waiting;
+        }
+        auto h = held.find(id);
+        if (h != held.end()) {
+            out = h->second;
+            return JobState::Paused;
+        }
+        for (const auto& p : printers) {
+            if (p.busy && p.current.id == id) {
+                out = p.current;
+                return JobState::Printing;
+            }
+        }
+        return JobState::Unknown;
     }
 
     // 获取统计信息
+    struct PrinterStats {
+        int id = 0;
+        double secPerPage = 0.0;
+        bool busy = false;
+        double utilisation = 0.0;   // 忙碌时间 / 总仿真时间
+        int jobsDone = 0;
+        long long pagesDone = 0;
+        double jobsPerHour = 0.0;   // 吞吐量
+    };
+
+    // 直方图和按用户统计见 doneStats
     struct Statistics {
         int totalCompleted = 0;
         double avgWaitTime = 0.0;
         double avgDuration = 0.0;
+        double stdWaitTime = 0.0;
+        double stdDuration = 0.0;
+        double maxWaitTime = 0.0;
+        double p50Wait = 0.0, p95Wait = 0.0, p99Wait = 0.0;
+        double p50Duration = 0.0, p95Duration = 0.0, p99Duration = 0.0;
+        double utilisation = 0.0;   // 全部打印机的平均利用率
+        std::vector<PrinterStats> printers;
+        // 截止时刻与准入控制
+        long long deadlineJobs = 0;   // 有截止时刻的已完成任务数
+        double onTimePct = 0.0;       // 其中按时完成的百分比
+        double p50Lateness = 0.0, p95Lateness = 0.0, p99Lateness = 0.0;   // 迟到秒数，按时完成记 0
+        int queueLimit = 0;           // 生效的等待队列长度上限（0 为不限）
+        long long rejected = 0;       // 准入控制拒绝、降级的提交数
+        long long demoted = 0;
+
+        // 由完成任务的增量统计填写等待/耗时部分（多个分片合并后的统计同样适用）
+        void setDone(const StatsAccumulator& a) {
+            totalCompleted = (int)a.wait.n;
+            avgWaitTime = a.wait.mean;
+            avgDuration = a.duration.mean;
+            stdWaitTime = a.wait.stddev();
+            stdDuration = a.duration.stddev();
+            maxWaitTime = a.wait.maxV;
+            p50Wait = a.waitQ.quantile(0.50);
+            p95Wait = a.waitQ.quantile(0.95);
+            p99Wait = a.waitQ.quantile(0.99);
+            p50Duration = a.durationQ.quantile(0.50);
+            p95Duration = a.durationQ.quantile(0.95);
+            p99Duration = a.durationQ.quantile(0.99);
+            deadlineJobs = (long long)a.latenessQ.total;
+            onTimePct = deadlineJobs > 0 ? 100.0 * a.onTime / deadlineJobs : 0.0;
+            p50Lateness = a.latenessQ.quantile(0.50);
+            p95Lateness = a.latenessQ.quantile(0.95);
+            p99Lateness = a.latenessQ.quantile(0.99);
+        }
     };
 
+    // 在不写文件的独立实例上跑同一批任务，返回统计结果
+    static Statistics simulate(const std::vector<JobSpec>& workload, QueueDiscipline d,
+                               int printerCount = 1, double sec_per_page = 2.0,
+                               double aging_rate = 0.01) {
+        PrintManager pm;
+        pm.persist = false;
+        pm.metrics = nullptr;   // 一次性的对比运行，不写进程级指标（与后台仿真线程的实例互不干扰）
+        pm.setSpeed(sec_per_page);
+        pm.setPrinterCount(printerCount);
+        pm.setDiscipline(d, aging_rate);
+        pm.addJobs(workload);
+        pm.runToEnd();
+        return pm.getStatistics();
+    }
+
+    // 对同一批任务依次尝试全部出队规则，便于按 avgWaitTime 比较
+    static std::vector<std::pair<QueueDiscipline, Statistics>>
+    compareDisciplines(const std::vector<JobSpec>& workload, int printerCount = 1,
+                       double sec_per_page = 2.0, double aging_rate = 0.01) {
+        std::vector<std::pair<QueueDiscipline, Statistics>> result;
+        for (QueueDiscipline d : {QueueDiscipline::Fifo, QueueDiscipline::Priority,
+                                  QueueDiscipline::ShortestJob, QueueDiscipline::ShortestRemaining,
+                                  QueueDiscipline::AgingPriority}) {
+            result.emplace_back(d, simulate(workload, d, printerCount, sec_per_page, aging_rate));
+        }
+        return result;
+    }
+
     Statistics getStatistics() const {
         Statistics stats;
-        stats.totalCompleted = done.size();
-        if (done.empty()) return stats;
-        
-        long long sumWait = 0, sumDur = 0;
-        for (const auto& j : done) {
-            sumWait += j.waitTime();
-            sumDur  += j.duration();
-        }
-        stats.avgWaitTime = (double)sumWait / done.size();
-        stats.avgDuration = (double)sumDur  / done.size();
+        stats.setDone(doneStats);
+        stats.queueLimit = queueLimit;
+        stats.rejected = rejectCount;
+        stats.demoted = demoteCount;
+        double hours = timeToSec(currentTime) / 3600.0;
+        for (const auto& p : printers) {
+            PrinterStats ps;
+            ps.id = p.id;
+            ps.secPerPage = p.secPerPage;
+            ps.busy = p.busy;
+            ps.utilisation = currentTime > 0 ? (double)p.busyTime / currentTime : 0.0;
+            ps.jobsDone = p.jobsDone;
+            ps.pagesDone = p.pagesDone;
+            ps.jobsPerHour = hours > 0 ? p.jobsDone / hours : 0.0;
+            stats.utilisation += ps.utilisation / printers.size();
+            stats.printers.push_back(ps);
+        }
         return stats;
     }
 };
 
 #endif // PRINTMANAGER_H
-
@@ -0,0 +1,234 @@
+#ifndef SHARDEDMANAGER_H
+#define SHARDEDMANAGER_H
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "printmanager.h"
+
+// 多租户分片管理器：每个站点（或打印机组）是一个独立的 PrintManager 分片，
+// 有自己的等待队列、打印机、完成记录、仿真时钟和数据目录，由各自的互斥锁保护。
+//
+// - 提交只锁目标分片，不同分片上的提交互不等待，吞吐量随核数增长；
+// - 任务 ID 来自共享的 IdAllocator：各分片按块领取，块内分配不碰共享变量，
+//   ID 全局唯一（不同分片之间不按提交先后排序）；
+// - 推进（tick / runToEnd）和快照在每个分片各自的线程上并行执行；
+// - 汇总统计把各分片的增量统计（均值方差、分位数草图、直方图）合并后计算，
+//   与把全部任务放进一个实例得到的结果一致（分位数在草图精度内）。
+//
+// 用户名、文档名的驻留仍经过进程级字符串池的锁；高并发提交应先驻留，再用 UserId/DocRef 版本。
+// 分片不写进程级运行时指标（与参数扫描相同，免得多个分片互相覆盖瞬时值）。
+
+struct ShardConfig {
+    std::string name;            // 站点 / 打印机组名称
+    int printers = 1;
+    double secPerPage = 2.0;
+    std::string dataDir;         // 快照、日志所在目录；为空时该分片不写文件
+};
+
+class ShardedManager {
+public:
+    explicit ShardedManager(const std::vector<ShardConfig>& configs) {
+        for (const auto& c : configs) {
+            auto sh = std::make_unique<Shard>();
+            sh->config = c;
+            PrintManager& pm = sh->pm;
+            pm.idAlloc = &ids;
+            pm.metrics = nullptr;
+            pm.persist = false;   // 初始配置不记日志；有数据目录时由 load() 恢复或补记
+            pm.setSpeed(c.secPerPage);
+            pm.setPrinterCount(c.printers);
+            if (!c.dataDir.empty()) {
+                std::error_code ec;
+                std::filesystem::create_directories(c.dataDir, ec);
+                pm.setDataDir(c.dataDir);
+                pm.persist = true;
+            }
+            shards.push_back(std::move(sh));
+        }
+    }
+
+    ShardedManager(const ShardedManager&) = delete;
+    ShardedManager& operator=(const ShardedManager&) = delete;
+
+    size_t size() const { return shards.size(); }
+
+    const std::string& name(size_t shard) const { return shards[shard]->config.name; }
+
+    // 按名称找分片，找不到返回 -1
+    int find(std::string_view name) const {
+        for (size_t i = 0; i < shards.size(); ++i) {
+            if (shards[i]->config.name == name) return (int)i;
+        }
+        return -1;
+    }
+
+    // 按用户路由：同一用户总在同一分片（用户公平等按用户的策略在分片内仍然成立）
+    size_t shardOfUser(UserId user) const {
+        uint64_t h = (uint64_t)user * 0x9E3779B97F4A7C15ULL;
+        return (size_t)((h >> 32) % shards.size());
+    }
+
+    // ========== 提交与取消 ==========
+    // 以下函数可在任意线程上调用；提交被分片的准入控制拒绝时返回 0
+
+    int submit(size_t shard, UserId user, DocRef doc, int pages, int priority = 0) {
+        Shard& sh = *shards[shard];
+        std::lock_guard<std::mutex> lock(sh.mutex);
+        return sh.pm.addJob(user, doc, pages, priority);
+    }
+
+    int submit(size_t shard, std::string_view user, std::string_view doc, int pages, int priority = 0) {
+        StringPool& strings = StringPool::global();   // 在分片锁之外驻留
+        return submit(shard, strings.internUser(user), strings.addDoc(doc), pages, priority);
+    }
+
+    // 提交时刻在未来的任务作为预约任务
+    int submit(size_t shard, const JobSpec& s) {
+        Shard& sh = *shards[shard];
+        std::lock_guard<std::mutex> lock(sh.mutex);
+        return sh.pm.addJobAt(s.user, s.doc, s.pages, s.submitTime, s.priority, s.deadline);
+    }
+
+    int submit(const JobSpec& s) {
+        return submit(shardOfUser(s.user), s);
+    }
+
+    // 一批任务提交到同一分片：连续 ID 区间，日志只同步一次（见 PrintManager::addJobs）
+    int submitBatch(size_t shard, const JobSpec* specs, size_t n) {
+        Shard& sh = *shards[shard];
+        std::lock_guard<std::mutex> lock(sh.mutex);
+        return sh.pm.addJobs(specs, n);
+    }
+    int submitBatch(size_t shard, const std::vector<JobSpec>& specs) {
+        return submitBatch(shard, specs.data(), specs.size());
+    }
+
+    // ID 不带分片信息，逐个分片查找
+    bool cancel(int id) {
+        for (auto& sh : shards) {
+            std::lock_guard<std::mutex> lock(sh->mutex);
+            if (sh->pm.cancelJob(id)) return true;
+        }
+        return false;
+    }
+
+    size_t cancelUserJobs(std::string_view user) {
+        size_t n = 0;
+        for (auto& sh : shards) {
+            std::lock_guard<std::mutex> lock(sh->mutex);
+            n += sh->pm.cancelUserJobs(user);
+        }
+        return n;
+    }
+
+    // 持有分片锁执行 f(PrintManager&)，用于单个分片上的其它操作（调速、查询等）
+    template <typename F>
+    auto with(size_t shard, F&& f) {
+        Shard& sh = *shards[shard];
+        std::lock_guard<std::mutex> lock(sh.mutex);
+        return f(sh.pm);
+    }
+
+    // ========== 推进与持久化（各分片并行） ==========
+
+    void tick(double sec) {
+        parallel([sec](PrintManager& pm) { pm.tick(sec); });
+    }
+
+    void runToEnd() {
+        parallel([](PrintManager& pm) { pm.runToEnd(); });
+    }
+
+    void saveAll() {
+        parallel([](PrintManager& pm) { pm.saveAll(); });
+    }
+
+    // 恢复有数据目录的分片；没有任何保存状态的分片按配置重新设置打印机。
+    // 之后共享分配器从所有分片已用过的最大 ID 之后继续分配
+    bool load() {
+        bool found = false;
+        for (auto& sh : shards) {
+            std::lock_guard<std::mutex> lock(sh->mutex);
+            PrintManager& pm = sh->pm;
+            if (!pm.persist) continue;
+            if (pm.load()) {
+                found = true;
+            } else {
+                pm.setSpeed(sh->config.secPerPage);
+                pm.setPrinterCount(sh->config.printers);
+            }
+            ids.raiseTo(pm.nextId);
+        }
+        return found;
+    }
+
+    // ========== 统计 ==========
+
+    // 全部分片合并后的统计；打印机按分片顺序依次编号，利用率相对各自分片的时钟
+    PrintManager::Statistics getStatistics() const {
+        PrintManager::Statistics stats;
+        StatsAccumulator all;
+        for (const auto& sh : shards) {
+            std::lock_guard<std::mutex> lock(sh->mutex);
+            all.merge(sh->pm.doneStats);
+            stats.queueLimit += sh->pm.queueLimit;   // 各分片各自限制，合计为总上限
+            stats.rejected += sh->pm.rejectCount;
+            stats.demoted += sh->pm.demoteCount;
+            for (auto ps : sh->pm.getStatistics().printers) {
+                ps.id = (int)stats.printers.size();
+                stats.printers.push_back(ps);
+            }
+        }
+        stats.setDone(all);
+        for (const auto& ps : stats.printers) stats.utilisation += ps.utilisation;
+        if (!stats.printers.empty()) stats.utilisation /= stats.printers.size();
+        return stats;
+    }
+
+    PrintManager::Statistics shardStatistics(size_t shard) const {
+        const Shard& sh = *shards[shard];
+        std::lock_guard<std::mutex> lock(sh.mutex);
+        return sh.pm.getStatistics();
+    }
+
+    size_t waitingCount() const {
+        size_t n = 0;
+        for (const auto& sh : shards) {
+            std::lock_guard<std::mutex> lock(sh->mutex);
+            n += sh->pm.waitQ.size();
+        }
+        return n;
+    }
+
+private:
+    // 每个分片独占缓存行，相邻分片的锁不会伪共享
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        PrintManager pm;
+        ShardConfig config;
+    };
+
+    // 每个分片在自己的线程上执行 f（调用线程负责第一个分片）
+    template <typename F>
+    void parallel(F f) {
+        auto run = [this, &f](size_t i) {
+            std::lock_guard<std::mutex> lock(shards[i]->mutex);
+            f(shards[i]->pm);
+        };
+        std::vector<std::thread> pool;
+        for (size_t i = 1; i < shards.size(); ++i) pool.emplace_back(run, i);
+        if (!shards.empty()) run(0);
+        for (auto& t : pool) t.join();
+    }
+
+    IdAllocator ids;   // 须先于分片构造、后于分片析构
+    std::vector<std::unique_ptr<Shard>> shards;
+};
+
+#endif // SHARDEDMANAGER_H
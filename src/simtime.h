@@ -0,0 +1,78 @@
+#ifndef SIMTIME_H
+#define SIMTIME_H
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+// 仿真时钟：64 位整数，单位微秒。
+// 引擎内部的时刻和时长都用 SimTime，不会在亚秒级页速下被取整成整秒；
+// 界面、CSV 和日志仍以秒为单位，整数秒写出来与旧版文件完全相同，
+// 小数部分最多 6 位（见 timeText / parseTime）。
+// 负值表示“未发生”（例如尚未开始的任务的 startTime）。
+using SimTime = long long;
+
+constexpr SimTime kTicksPerSec = 1000000;
+
+inline SimTime secToTime(double sec) {
+    return (SimTime)std::llround(sec * (double)kTicksPerSec);
+}
+
+inline double timeToSec(SimTime t) {
+    return (double)t / (double)kTicksPerSec;
+}
+
+// 写成十进制秒：整数秒不带小数点，否则去掉末尾的 0；负值一律写成 -1
+inline std::string timeText(SimTime t) {
+    if (t < 0) return "-1";
+    char buf[32];
+    long long sec = t / kTicksPerSec;
+    long long frac = t % kTicksPerSec;
+    if (frac == 0) {
+        std::snprintf(buf, sizeof(buf), "%lld", sec);
+        return buf;
+    }
+    int n = std::snprintf(buf, sizeof(buf), "%lld.%06lld", sec, frac);
+    while (n > 0 && buf[n - 1] == '0') --n;
+    return std::string(buf, (size_t)n);
+}
+
+// 解析十进制秒（旧版文件中的整数秒也按此读取）。
+// 常见写法逐位解析，结果精确到微秒；其它写法（如科学计数法）退回 strtod
+inline SimTime parseTime(std::string_view s, SimTime def = 0) {
+    if (s.empty()) return def;
+    size_t i = 0;
+    bool neg = s[0] == '-';
+    if (neg) i = 1;
+    SimTime sec = 0, frac = 0;
+    int digits = 0;
+    bool any = false, dot = false;
+    for (; i < s.size(); ++i) {
+        char c = s[i];
+        if (c == '.' && !dot) {
+            dot = true;
+            continue;
+        }
+        if (c < '0' || c > '9') {
+            std::string tmp(s);
+            char* endp = nullptr;
+            double v = std::strtod(tmp.c_str(), &endp);
+            if (endp == tmp.c_str()) return def;
+            return v < 0 ? -1 : secToTime(v);
+        }
+        any = true;
+        if (!dot) sec = sec * 10 + (c - '0');
+        else if (digits < 6) {
+            frac = frac * 10 + (c - '0');
+            ++digits;
+        }
+    }
+    if (!any) return def;
+    if (neg) return -1;
+    for (; digits < 6; ++digits) frac *= 10;
+    return sec * kTicksPerSec + frac;
+}
+
+#endif // SIMTIME_H
@@ -0,0 +1,390 @@
+#ifndef SIMWORKER_H
+#define SIMWORKER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "printmanager.h"
+#include "mpscqueue.h"
+
+// 界面一侧的完成记录副本：随引擎的热数据窗口一起滑动
+struct DoneMirror {
+    std::deque<PrintJob> jobs;
+    uint64_t first = 0;   // jobs.front() 的全局序号
+    uint64_t end() const { return first + jobs.size(); }
+};
+
+// 等待队列的一段变化。reset 为 true 时 added 是整个队列（到达顺序），此前的行全部作废；
+// 否则先删 removed 再加 added。seq 是入队序号：规则的键相同时按它排在前面，
+// 与引擎的出队顺序一致（见 compareJobs）
+struct WaitingDelta {
+    unsigned long long version = 0;   // 应用后对应的队列版本
+    bool reset = false;
+    QueueDiscipline discipline = QueueDiscipline::Fifo;
+    double agingRate = 0.0;           // 队列内部的老化系数（按 SimTime 计）
+    std::vector<int> removed;
+    std::vector<std::pair<unsigned long long, PrintJob>> added;
+};
+
+// 后台线程发布的只读状态快照：发布后不再修改，界面线程读取时无需加锁。
+struct SimSnapshot {
+    unsigned long long seq = 0;      // 发布序号
+    SimTime currentTime = 0;
+    double secPerPage = 2.0;
+    DispatchPolicy policy = DispatchPolicy::Fifo;
+    QueueDiscipline discipline = QueueDiscipline::Fifo;
+    double agingRate = 0.0;
+    bool preempt = false;
+    int splitPages = 0;
+    AdmissionPolicy admission = AdmissionPolicy::Off;
+    int queueLimit = 0;
+    bool running = false;            // 是否正在后台执行“运行至完成”
+    double paceSpeedup = 0.0;        // 实时模式的倍速，0 表示未开启
+    SimTime paceLag = 0;             // 实时模式下仿真时钟落后于目标时刻的量（事件太多来不及处理时 > 0）
+    std::vector<Printer> printers;
+    std::vector<PrintJob> held;      // 已暂停的任务（按 ID）
+
+    // 等待队列只发布增量：waitingDeltas 依次应用即得到版本 waitingVersion 的队列。
+    // 界面通过 SimWorker::ackWaiting() 确认已应用到的版本，确认过的段不再出现在之后的快照里
+    std::vector<std::shared_ptr<const WaitingDelta>> waitingDeltas;
+    unsigned long long waitingVersion = 0;
+
+    // 已完成任务只发布增量：doneSegments 依次覆盖全局序号 [doneBase, doneCount)。
+    // 界面通过 SimWorker::ackDone() 确认已复制到的序号，确认过的段不再出现在之后的快照里。
+    // doneFirst 是引擎热数据窗口内最早一条的序号，界面副本同样只保留此后的记录。
+    std::vector<std::shared_ptr<const std::vector<PrintJob>>> doneSegments;
+    uint64_t doneBase = 0;
+    uint64_t doneCount = 0;
+    uint64_t doneFirst = 0;
+
+    PrintManager::Statistics stats;
+    std::vector<uint64_t> pageHistogram;   // doneStats.pages 的副本
+
+    // 把 mirror 中还没有的完成记录追加进去，并逐出窗口之外的记录
+    void appendDone(DoneMirror& mirror) const {
+        // 引擎一侧重置过，或中间的记录在发布前就已逐出：从头接上
+        if (doneCount < mirror.end() || mirror.end() < doneBase) {
+            mirror.jobs.clear();
+            mirror.first = doneBase;
+        }
+        uint64_t at = doneBase;
+        for (const auto& seg : doneSegments) {
+            uint64_t end = at + seg->size();
+            if (end > mirror.end()) {
+                mirror.jobs.insert(mirror.jobs.end(), seg->begin() + (size_t)(mirror.end() - at), seg->end());
+            }
+            at = end;
+        }
+        if (doneFirst > mirror.first) {
+            size_t drop = (size_t)std::min<uint64_t>(doneFirst - mirror.first, mirror.jobs.size());
+            mirror.jobs.erase(mirror.jobs.begin(), mirror.jobs.begin() + drop);
+            mirror.first += drop;
+        }
+    }
+};
+
+// 在独立线程上运行 PrintManager。
+// 其它线程通过无锁的多生产者队列投递命令（闭包，在后台线程上按投递顺序执行），
+// 通过 snapshot() 读取最近一次发布的不可变快照。
+// runToEnd() 在后台分段执行，段与段之间照常处理新命令，因此可以随时 cancelRun()。
+// setPace() 开启实时模式：仿真时钟按单调墙钟的若干倍前进，与界面刷新频率无关。
+class SimWorker {
+public:
+    using Command = std::function<void(PrintManager&)>;
+
+    int sliceEvents = 4096;                            // 每段最多处理的事件数
+    std::chrono::milliseconds publishInterval{30};     // 两次发布之间的最短间隔
+    std::chrono::milliseconds paceInterval{33};        // 实时模式下追上墙钟后休眠的时长（约一帧）
+    static constexpr double kMaxSpeedup = 1e6;
+
+    // 以下回调在后台线程上调用，须在 start() 之前设置
+    std::function<void()> onPublish;                   // 发布了新快照
+    std::function<void(bool completed)> onRunFinished; // 运行至完成结束（false 表示被中止）
+
+    SimWorker() = default;
+    SimWorker(const SimWorker&) = delete;
+    SimWorker& operator=(const SimWorker&) = delete;
+    ~SimWorker() { stop(); }
+
+    // 启动后台线程；init（例如从文件恢复）在后台线程上执行，第一份快照发布后才返回
+    void start(Command init = nullptr) {
+        if (thread.joinable()) return;
+        std::promise<void> ready;
+        std::future<void> started = ready.get_future();
+        thread = std::thread([this, init, &ready]() {
+            pm.waitQ.trackChanges = true;
+            if (init) init(pm);
+            publish();
+            ready.set_value();
+            loop();
+        });
+        started.wait();
+    }
+
+    // 先执行完已投递的命令，再结束后台线程
+    void stop() {
+        if (!thread.joinable()) return;
+        post([this](PrintManager&) { quitting = true; });
+        thread.join();
+    }
+
+    void post(Command c) {
+        commands.push(std::move(c));
+        if (sleeping.load()) {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            wakeup.notify_one();
+        }
+    }
+
+    void runToEnd() {
+        post([this](PrintManager&) {
+            if (running) return;
+            running = true;
+            dirty = true;
+        });
+    }
+
+    void cancelRun() {
+        post([this](PrintManager&) { finishRun(false); });
+    }
+
+    // 实时模式：仿真时钟每墙钟秒前进 speedup 秒；speedup <= 0 时停止。
+    // 改倍速时从当前时刻重新计时，已走过的部分不受影响
+    void setPace(double speedup) {
+        post([this, speedup](PrintManager& pm) {
+            paceSpeedup = speedup > 0 ? std::min(speedup, kMaxSpeedup) : 0.0;
+            rebasePace(pm.currentTime);
+            paceLag = 0;
+        });
+    }
+
+    std::shared_ptr<const SimSnapshot> snapshot() const {
+        return std::atomic_load(&current);
+    }
+
+    // 界面已复制到序号 seq（不含）
+    void ackDone(uint64_t seq) {
+        doneAcked.store(seq, std::memory_order_relaxed);
+    }
+
+    // 界面的等待表格已应用到队列版本 version
+    void ackWaiting(unsigned long long version) {
+        waitingAcked.store(version, std::memory_order_relaxed);
+    }
+
+private:
+    void loop() {
+        while (!quitting) {
+            Command c;
+            while (!quitting && commands.pop(c)) {
+                c(pm);
+                dirty = true;
+            }
+            if (quitting) break;
+
+            bool behind = false;
+            if (running) {
+                if (pm.runFor(sliceEvents)) finishRun(true);
+            } else if (paceSpeedup > 0) {
+                behind = stepPace();
+            }
+            pm.syncJournal();
+
+            auto now = std::chrono::steady_clock::now();
+            if (dirty && now - lastPublish >= publishInterval) publish();
+            if (running || behind) continue;
+
+            // 空闲：等待新命令；有未发布的改动时最多等到下一次可发布的时刻，实时模式下最多等 paceInterval
+            auto wait = dirty ? publishInterval - (now - lastPublish)
+                              : std::chrono::steady_clock::duration(std::chrono::milliseconds(pm.journal.intervalMs));
+            if (paceSpeedup > 0) wait = std::min<std::chrono::steady_clock::duration>(wait, paceInterval);
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            sleeping.store(true);
+            wakeup.wait_for(lock, wait, [this] { return !commands.empty(); });
+            sleeping.store(false);
+        }
+        publish();
+    }
+
+    void finishRun(bool completed) {
+        if (!running) return;
+        running = false;
+        rebasePace(pm.currentTime);   // 实时模式从运行结束的时刻接着走
+        publish();
+        if (onRunFinished) onRunFinished(completed);
+    }
+
+    // —— 实时模式
+    // 目标时刻 = 计时起点的仿真时刻 + 墙钟经过时间 × 倍速。每一步推进到目标时刻，
+    // 其间的事件按各自的仿真时刻逐个处理，醒来的早晚只影响显示，不会跳过或合并事件。
+    // 一步最多处理 sliceEvents 个事件；没追上时返回 true，主循环处理完新命令后立即继续追赶
+    bool stepPace() {
+        auto now = std::chrono::steady_clock::now();
+        double wall = std::chrono::duration<double>(now - paceWall0).count();
+        SimTime target = paceSim0 + secToTime(wall * paceSpeedup);
+        if (pm.currentTime > target) {   // 手动推进或运行至完成把时钟推到了前面：从这里重新计时
+            rebasePace(pm.currentTime);
+            paceLag = 0;
+            return false;
+        }
+        if (pm.currentTime == target) return false;
+        pm.advance(target, false, sliceEvents);
+        dirty = true;
+        paceLag = target - pm.currentTime;
+        return paceLag > 0;
+    }
+
+    void rebasePace(SimTime simNow) {
+        paceWall0 = std::chrono::steady_clock::now();
+        paceSim0 = simNow;
+    }
+
+    void publish() {
+        auto s = std::make_shared<SimSnapshot>();
+        s->seq = ++seq;
+        s->currentTime = pm.currentTime;
+        s->secPerPage = pm.secPerPage;
+        s->policy = pm.policy;
+        s->discipline = pm.discipline;
+        s->agingRate = pm.agingRate;
+        s->preempt = pm.preempt;
+        s->splitPages = pm.splitPages;
+        s->admission = pm.admission;
+        s->queueLimit = pm.queueLimit;
+        s->running = running;
+        s->paceSpeedup = paceSpeedup;
+        s->paceLag = paceLag;
+        s->printers = pm.printers;
+        for (const auto& h : pm.held) s->held.push_back(h.second);
+        pm.publishMetrics();   // 命令（添加、取消）不经过 advance，也要刷新队列长度等瞬时值
+
+        publishWaiting();
+        s->waitingDeltas = waitingDeltas;
+        s->waitingVersion = pm.waitQ.version;
+
+        // 完成记录：新增部分打包成一段；丢弃界面已确认的段和已逐出窗口的段
+        uint64_t total = pm.done.total();
+        uint64_t first = pm.done.first();
+        if (total < donePublished) {
+            doneSegments.clear();
+            doneBase = 0;
+            donePublished = 0;
+        }
+        if (donePublished < first) {   // 两次发布之间完成的记录多于保留条数
+            doneSegments.clear();
+            doneBase = donePublished = first;
+        }
+        if (total > donePublished) {
+            auto seg = std::make_shared<std::vector<PrintJob>>();
+            seg->reserve((size_t)(total - donePublished));
+            for (uint64_t q = donePublished; q < total; ++q) seg->push_back(*pm.done.at(q));
+            doneSegments.push_back(std::move(seg));
+            donePublished = total;
+        }
+        uint64_t acked = std::max<uint64_t>(doneAcked.load(std::memory_order_relaxed), first);
+        size_t drop = 0;
+        while (drop < doneSegments.size() && doneBase + doneSegments[drop]->size() <= acked) {
+            doneBase += doneSegments[drop]->size();
+            ++drop;
+        }
+        doneSegments.erase(doneSegments.begin(), doneSegments.begin() + drop);
+        s->doneSegments = doneSegments;
+        s->doneBase = doneBase;
+        s->doneCount = donePublished;
+        s->doneFirst = first;
+
+        s->stats = pm.getStatistics();
+        s->pageHistogram = pm.doneStats.pages.buckets;
+
+        std::atomic_store(&current, std::shared_ptr<const SimSnapshot>(std::move(s)));
+        lastPublish = std::chrono::steady_clock::now();
+        dirty = false;
+        if (onPublish) onPublish();
+    }
+
+    // 等待队列：把上次发布以来的变化按 ID 抵消后打包成一段。
+    // 段的总量超过队列本身时（例如没有界面确认）改为一段整体重取，积压因此有上限
+    void publishWaiting() {
+        JobQueue& q = pm.waitQ;
+        unsigned long long acked = waitingAcked.load(std::memory_order_relaxed);
+        size_t drop = 0;
+        while (drop < waitingDeltas.size() && waitingDeltas[drop]->version <= acked) {
+            waitingPending -= waitingDeltas[drop]->removed.size() + waitingDeltas[drop]->added.size();
+            ++drop;
+        }
+        waitingDeltas.erase(waitingDeltas.begin(), waitingDeltas.begin() + drop);
+        if (!q.changesLost && q.changes.empty()) return;
+
+        auto d = std::make_shared<WaitingDelta>();
+        d->version = q.version;
+        d->discipline = q.discipline;
+        d->agingRate = q.agingRate;
+        if (!q.changesLost) {
+            // 每个 ID 只看第一次和最后一次：一开始就在的要删，最后还在的要加
+            struct Net { bool wasIn = false; unsigned long long seq = 0; bool seen = false; };
+            std::unordered_map<int, Net> net;
+            for (const auto& c : q.changes) {
+                Net& n = net[c.id];
+                if (!n.seen) n.wasIn = c.seq == 0;
+                n.seen = true;
+                n.seq = c.seq;
+            }
+            for (const auto& e : net) {
+                if (e.second.wasIn) d->removed.push_back(e.first);
+                if (e.second.seq != 0) {
+                    if (const PrintJob* j = q.find(e.first)) d->added.emplace_back(e.second.seq, *j);
+                }
+            }
+            q.changes.clear();
+        }
+        if (q.changesLost || waitingPending + d->removed.size() + d->added.size() > q.size() + 1024) {
+            d->reset = true;
+            d->removed.clear();
+            d->added.clear();
+            d->added.reserve(q.size());
+            q.resyncChanges([&](const PrintJob& j, unsigned long long seq) { d->added.emplace_back(seq, j); });
+            waitingDeltas.clear();
+            waitingPending = 0;
+        }
+        waitingPending += d->removed.size() + d->added.size();
+        waitingDeltas.push_back(std::move(d));
+    }
+
+    PrintManager pm;                 // 只在后台线程上访问
+    std::thread thread;
+    MpscQueue<Command> commands;
+    std::atomic<bool> sleeping{false};
+    std::mutex wakeMutex;            // 仅用于空闲时休眠/唤醒，命令本身不经过锁
+    std::condition_variable wakeup;
+    std::shared_ptr<const SimSnapshot> current;   // 通过 atomic_load/atomic_store 访问
+
+    // —— 以下只在后台线程上访问
+    bool quitting = false;
+    bool running = false;
+    bool dirty = false;
+    double paceSpeedup = 0.0;
+    SimTime paceLag = 0;
+    SimTime paceSim0 = 0;
+    std::chrono::steady_clock::time_point paceWall0;
+    unsigned long long seq = 0;
+    std::chrono::steady_clock::time_point lastPublish;
+    std::vector<std::shared_ptr<const WaitingDelta>> waitingDeltas;
+    size_t waitingPending = 0;       // waitingDeltas 里删除与新增的总条数
+    std::vector<std::shared_ptr<const std::vector<PrintJob>>> doneSegments;
+    uint64_t doneBase = 0;
+    uint64_t donePublished = 0;
+
+    std::atomic<uint64_t> doneAcked{0};
+    std::atomic<unsigned long long> waitingAcked{0};
+};
+
+#endif // SIMWORKER_H
@@ -0,0 +1,166 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+// 增量统计：每完成一个任务更新一次，读取时不再扫描完成日志。
+
+// 计数、均值、方差、最值（Welford 算法，数值稳定，可合并）
+struct RunningStat {
+    long long n = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double minV = 0.0;
+    double maxV = 0.0;
+
+    void add(double x) {
+        ++n;
+        double d = x - mean;
+        mean += d / n;
+        m2 += d * (x - mean);
+        if (n == 1 || x < minV) minV = x;
+        if (n == 1 || x > maxV) maxV = x;
+    }
+
+    void merge(const RunningStat& o) {
+        if (o.n == 0) return;
+        if (n == 0) { *this = o; return; }
+        long long total = n + o.n;
+        double d = o.mean - mean;
+        mean += d * o.n / total;
+        m2 += o.m2 + d * d * ((double)n * o.n / total);
+        minV = std::min(minV, o.minV);
+        maxV = std::max(maxV, o.maxV);
+        n = total;
+    }
+
+    double variance() const { return n > 1 ? m2 / (n - 1) : 0.0; }
+    double stddev() const { return std::sqrt(variance()); }
+};
+
+// 流式分位数：对数分桶（相对误差 alpha），桶数只与取值范围有关，
+// 与样本数无关；可合并。小于 minValue 的样本（包括 0）计入零桶。
+struct QuantileSketch {
+    double minValue = 1e-3;
+    double logGamma = std::log((1 + 0.01) / (1 - 0.01));   // alpha = 1%
+    uint64_t zeroCount = 0;
+    uint64_t total = 0;
+    std::vector<uint64_t> buckets;
+
+    void add(double x) {
+        ++total;
+        if (x < minValue) { ++zeroCount; return; }
+        size_t i = (size_t)std::ceil(std::log(x / minValue) / logGamma);
+        if (i >= buckets.size()) buckets.resize(i + 1, 0);
+        ++buckets[i];
+    }
+
+    void merge(const QuantileSketch& o) {
+        zeroCount += o.zeroCount;
+        total += o.total;
+        if (o.buckets.size() > buckets.size()) buckets.resize(o.buckets.size(), 0);
+        for (size_t i = 0; i < o.buckets.size(); ++i) buckets[i] += o.buckets[i];
+    }
+
+    // q ∈ [0,1]；返回桶的代表值，相对误差不超过 alpha
+    double quantile(double q) const {
+        if (total == 0) return 0.0;
+        uint64_t rank = (uint64_t)(q * (total - 1));
+        if (rank < zeroCount) return 0.0;
+        uint64_t seen = zeroCount;
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            seen += buckets[i];
+            if (seen > rank) {
+                double gamma = std::exp(logGamma);
+                return minValue * 2 * std::pow(gamma, (double)i) / (gamma + 1);
+            }
+        }
+        return 0.0;
+    }
+};
+
+// 以 2 为底的对数直方图：第 k 个桶统计 [2^k, 2^(k+1)) 的取值
+struct Log2Histogram {
+    std::vector<uint64_t> buckets;
+
+    static size_t bucketOf(long long v) {
+        size_t k = 0;
+        while (v > 1) { v >>= 1; ++k; }
+        return k;
+    }
+
+    void add(long long v) {
+        size_t k = bucketOf(v);
+        if (k >= buckets.size()) buckets.resize(k + 1, 0);
+        ++buckets[k];
+    }
+
+    void merge(const Log2Histogram& o) {
+        if (o.buckets.size() > buckets.size()) buckets.resize(o.buckets.size(), 0);
+        for (size_t i = 0; i < o.buckets.size(); ++i) buckets[i] += o.buckets[i];
+    }
+};
+
+// 每个用户的完成情况（按用户名编号，见 stringpool.h）
+struct UserStat {
+    long long jobs = 0;
+    long long pages = 0;
+    double waitSum = 0.0;
+};
+
+// 已完成任务的全部增量统计
+struct StatsAccumulator {
+    RunningStat wait;
+    RunningStat duration;
+    QuantileSketch waitQ;
+    QuantileSketch durationQ;
+    Log2Histogram pages;
+    std::unordered_map<uint32_t, UserStat> users;
+    // 有截止时刻的任务：按时完成数和迟到秒数（按时完成记 0）的分位数
+    long long onTime = 0;
+    QuantileSketch latenessQ;
+
+    void add(uint32_t user, int jobPages, double waitTime, double durationTime) {
+        wait.add(waitTime);
+        duration.add(durationTime);
+        waitQ.add(waitTime);
+        durationQ.add(durationTime);
+        pages.add(jobPages);
+        UserStat& u = users[user];
+        u.jobs++;
+        u.pages += jobPages;
+        u.waitSum += waitTime;
+    }
+
+    // lateness = 完成时刻 - 截止时刻（秒），不大于 0 为按时完成
+    void addDeadline(double lateness) {
+        if (lateness <= 0) ++onTime;
+        latenessQ.add(std::max(0.0, lateness));
+    }
+
+    void merge(const StatsAccumulator& o) {
+        wait.merge(o.wait);
+        duration.merge(o.duration);
+        waitQ.merge(o.waitQ);
+        durationQ.merge(o.durationQ);
+        pages.merge(o.pages);
+        for (const auto& kv : o.users) {
+            UserStat& u = users[kv.first];
+            u.jobs += kv.second.jobs;
+            u.pages += kv.second.pages;
+            u.waitSum += kv.second.waitSum;
+        }
+        onTime += o.onTime;
+        latenessQ.merge(o.latenessQ);
+    }
+
+    void clear() {
+        *this = StatsAccumulator();
+    }
+};
+
+#endif // STATS_H
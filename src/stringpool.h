@@ -0,0 +1,152 @@
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// 用户名编号：相同用户名只存一份，任务里只记 32 位编号（0 表示空用户名）
+using UserId = uint32_t;
+
+// 文档名在字节区中的位置
+struct DocRef {
+    uint32_t chunk = 0;
+    uint32_t offset = 0;
+    uint32_t length = 0;   // 0 表示空文档名
+};
+
+// 进程级字符串池：用户名驻留为编号，文档名追加到只增不减的字节区（相同的文档名只存一份）。
+// 字节区按块分配，已写入的内容地址永不改变，因此
+//   - 写入（internUser / addDoc）在互斥锁内进行；
+//   - 读取（user / doc）不加锁，可在任意线程上进行，只要拿到的编号/位置
+//     是经由正常的线程间同步（例如快照发布）传过来的。
+// 池与进程同寿命：任务记录因此可以是不含指针所有权的平凡可复制结构。
+//
+// 代价是字节区从不回收：占用随出现过的不同用户名、文档名增长，而不是随提交次数。
+// 文档名去重索引最多记 kMaxDocIndex 个，超出后新的文档名照常写入但不再去重；
+// 长期运行、几乎每次提交都带新文档名的服务（例如 --serve 收到的唯一文件名）因此仍会持续增长，
+// 块用尽（kMaxChunks 个）时 addDoc 抛出 std::length_error。
+class StringPool {
+public:
+    static StringPool& global() {
+        static StringPool pool;
+        return pool;
+    }
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    UserId internUser(std::string_view name) {
+        if (name.empty()) return 0;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = userIds.find(name);
+        if (it != userIds.end()) return it->second;
+        UserId id = (UserId)userCount.load(std::memory_order_relaxed);
+        size_t seg = id / kUserSegment;
+        if (seg >= kMaxUserSegments) throw std::length_error("StringPool: too many users");
+        DocRef* block = userSegments[seg].load(std::memory_order_relaxed);
+        if (!block) {
+            block = new DocRef[kUserSegment];
+            userSegments[seg].store(block, std::memory_order_release);
+        }
+        DocRef ref = append(name);
+        block[id % kUserSegment] = ref;
+        userIds.emplace(view(ref), id);   // 键指向字节区，不再另存一份
+        userCount.store(id + 1, std::memory_order_release);
+        return id;
+    }
+
+    // 只查不驻留：未出现过的用户名返回 0
+    UserId findUser(std::string_view name) const {
+        if (name.empty()) return 0;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = userIds.find(name);
+        return it == userIds.end() ? 0 : it->second;
+    }
+
+    std::string_view user(UserId id) const {
+        if (id == 0) return std::string_view();
+        const DocRef* block = userSegments[id / kUserSegment].load(std::memory_order_acquire);
+        return view(block[id % kUserSegment]);
+    }
+
+    // 已知的用户名编号（含 0）
+    size_t users() const { return userCount.load(std::memory_order_acquire); }
+
+    DocRef addDoc(std::string_view text) {
+        if (text.empty()) return DocRef();
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = docRefs.find(text);
+        if (it != docRefs.end()) return it->second;
+        DocRef ref = append(text);
+        if (docRefs.size() < kMaxDocIndex) docRefs.emplace(view(ref), ref);
+        return ref;
+    }
+
+    std::string_view doc(DocRef r) const { return view(r); }
+
+    // 字节区已占用的字节数
+    size_t bytes() const { return used.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t kChunk = 1 << 20;            // 普通块 1MB；更长的文本独占一块
+    static constexpr size_t kMaxChunks = 1 << 16;
+    static constexpr size_t kUserSegment = 4096;
+    static constexpr size_t kMaxUserSegments = 1 << 12;  // 最多约 1600 万个不同用户名
+    static constexpr size_t kMaxDocIndex = 1 << 20;      // 去重索引的上限，约 100 万个不同文档名
+
+    StringPool() {
+        for (auto& c : chunks) c.store(nullptr, std::memory_order_relaxed);
+        for (auto& s : userSegments) s.store(nullptr, std::memory_order_relaxed);
+        userCount.store(1, std::memory_order_relaxed);  // 0 号保留给空用户名
+    }
+
+    // 调用者持有 mutex
+    DocRef append(std::string_view text) {
+        size_t n = text.size();
+        if (!current || pos + n > capacity) {
+            if (chunkCount >= kMaxChunks) throw std::length_error("StringPool: arena exhausted");
+            capacity = n > kChunk ? n : kChunk;
+            current = new char[capacity];
+            pos = 0;
+            chunks[chunkCount].store(current, std::memory_order_release);
+            ++chunkCount;
+        }
+        std::memcpy(current + pos, text.data(), n);
+        DocRef r;
+        r.chunk = (uint32_t)(chunkCount - 1);
+        r.offset = (uint32_t)pos;
+        r.length = (uint32_t)n;
+        pos += n;
+        used.fetch_add(n, std::memory_order_relaxed);
+        return r;
+    }
+
+    std::string_view view(DocRef r) const {
+        if (r.length == 0) return std::string_view();
+        const char* base = chunks[r.chunk].load(std::memory_order_acquire);
+        return std::string_view(base + r.offset, r.length);
+    }
+
+    // 块和用户段一经分配不再释放（进程结束时由操作系统回收）
+    std::atomic<char*> chunks[kMaxChunks];
+    std::atomic<DocRef*> userSegments[kMaxUserSegments];
+    std::atomic<size_t> userCount;
+    std::atomic<size_t> used{0};
+
+    // —— 以下只在持有 mutex 时访问
+    mutable std::mutex mutex;
+    std::unordered_map<std::string_view, UserId> userIds;
+    std::unordered_map<std::string_view, DocRef> docRefs;   // 键同样指向字节区
+    char* current = nullptr;
+    size_t pos = 0;
+    size_t capacity = 0;
+    size_t chunkCount = 0;
+};
+
+#endif // STRINGPOOL_H
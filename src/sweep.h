@@ -0,0 +1,223 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "printmanager.h"
+#include "workload.h"
+
+// 参数扫描：在 速度 × 到达率 × 打印机数 × 排队规则 的网格上，每个点用不同种子
+// 重复运行若干次，汇总成均值和 95% 置信区间。
+//
+// 每次运行是一个独立的 PrintManager（不写文件、不保留完成记录，只用增量统计），
+// 工作负载由 WorkloadGenerator 流式产生。各次运行之间不共享可变状态，
+// 工作线程从一个原子计数器领取下一个运行编号，结果写入各自的槽位，无需加锁，
+// 因此吞吐量随核数线性增长，直到内存带宽成为瓶颈。
+//
+// 第 r 次重复在所有网格点上使用同一个种子（公共随机数）：不同参数面对的是同一批任务，
+// 点与点之间的差异不被工作负载的随机波动淹没。
+
+// 网格上的一个点
+struct SweepPoint {
+    double secPerPage = 2.0;
+    double rate = 0.1;        // 平均每秒到达数
+    int printers = 1;
+    QueueDiscipline discipline = QueueDiscipline::Fifo;
+};
+
+// 一个指标在各次重复上的汇总
+struct Estimate {
+    int n = 0;
+    double mean = 0.0;
+    double stddev = 0.0;
+    double half = 0.0;        // 95% 置信区间半宽（Student t）
+    double min = 0.0;
+    double max = 0.0;
+
+    static Estimate of(const std::vector<double>& xs) {
+        Estimate e;
+        e.n = (int)xs.size();
+        if (e.n == 0) return e;
+        e.min = *std::min_element(xs.begin(), xs.end());
+        e.max = *std::max_element(xs.begin(), xs.end());
+        for (double x : xs) e.mean += x;
+        e.mean /= e.n;
+        if (e.n < 2) return e;
+        double ss = 0.0;
+        for (double x : xs) ss += (x - e.mean) * (x - e.mean);
+        e.stddev = std::sqrt(ss / (e.n - 1));
+        e.half = tQuantile(e.n - 1) * e.stddev / std::sqrt((double)e.n);
+        return e;
+    }
+
+    // 双侧 95% 的 t 分位数
+    static double tQuantile(int df) {
+        static const double table[] = {
+            12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+        if (df < 1) return 0.0;
+        if (df <= 30) return table[df - 1];
+        if (df <= 60) return 2.000;
+        if (df <= 120) return 1.980;
+        return 1.960;
+    }
+};
+
+// 单次运行的结果
+struct SweepRun {
+    double avgWait = 0.0;
+    double p95Wait = 0.0;
+    double utilisation = 0.0;
+    double makespan = 0.0;
+    double onTimePct = 0.0;   // 有截止时刻的任务中按时完成的百分比
+    double rejectedPct = 0.0; // 被准入控制拒绝的提交占全部提交的百分比
+};
+
+struct SweepResult {
+    SweepPoint point;
+    Estimate avgWait;
+    Estimate p95Wait;
+    Estimate utilisation;
+    Estimate makespan;
+    Estimate onTimePct;
+    Estimate rejectedPct;
+};
+
+struct SweepConfig {
+    WorkloadSpec workload;                 // 到达率取 rates 中的值，jobs 必须有限
+    std::vector<double> speeds = {2.0};
+    std::vector<double> rates;             // 为空时只用 workload.rate
+    std::vector<int> printers = {1};
+    std::vector<QueueDiscipline> disciplines = {QueueDiscipline::Fifo};
+    DispatchPolicy policy = DispatchPolicy::Fifo;
+    double agingRate = 0.01;
+    bool preempt = false;                  // 页边界抢占（见 PrintManager::preempt）
+    int splitPages = 0;                    // 大任务拆分阈值（见 PrintManager::splitPages）
+    AdmissionPolicy admission = AdmissionPolicy::Off;   // 准入控制（见 PrintManager::admit）
+    int queueLimit = 0;
+    int replications = 10;
+
+    std::vector<SweepPoint> points() const {
+        std::vector<double> rs = rates.empty() ? std::vector<double>{workload.rate} : rates;
+        std::vector<SweepPoint> out;
+        for (double s : speeds)
+            for (double r : rs)
+                for (int p : printers)
+                    for (QueueDiscipline d : disciplines) {
+                        SweepPoint pt;
+                        pt.secPerPage = s;
+                        pt.rate = r;
+                        pt.printers = p;
+                        pt.discipline = d;
+                        out.push_back(pt);
+                    }
+        return out;
+    }
+};
+
+class ParameterSweep {
+public:
+    SweepConfig config;
+    unsigned threads = 0;   // 0 表示 std::thread::hardware_concurrency()
+    // 每完成一次运行调用一次（在工作线程上，参数为已完成数和总数）
+    std::function<void(size_t done, size_t total)> onProgress;
+
+    explicit ParameterSweep(SweepConfig c = SweepConfig()) : config(std::move(c)) {}
+
+    // 第 rep 次重复的种子：由基础种子派生，与网格点无关
+    uint64_t seedFor(int rep) const {
+        uint64_t z = config.workload.seed + 0x9E3779B97F4A7C15ULL * (uint64_t)(rep + 1);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // 在独立实例上跑一个点的一次重复
+    SweepRun runOnce(const SweepPoint& pt, uint64_t seed) const {
+        WorkloadSpec spec = config.workload;
+        if (spec.rate > 0) spec.burstRate *= pt.rate / spec.rate;   // MMPP 的突发期按同一比例缩放
+        spec.rate = pt.rate;
+        spec.seed = seed;
+
+        PrintManager pm;
+        pm.persist = false;
+        pm.metrics = nullptr;  // 多个线程同时运行，不写进程级指标
+        pm.done.maxJobs = 1;   // 只需要增量统计
+        pm.setSpeed(pt.secPerPage);
+        pm.setPrinterCount(pt.printers);
+        pm.setPolicy(config.policy);
+        pm.setDiscipline(pt.discipline, config.agingRate);
+        pm.setPreemption(config.preempt);
+        pm.setSplitPages(config.splitPages);
+        pm.setAdmission(config.admission, config.queueLimit);
+        WorkloadGenerator gen(spec);
+        pm.setSource([&gen](JobSpec& s) { return gen.next(s); });
+        pm.runToEnd();
+
+        PrintManager::Statistics st = pm.getStatistics();
+        SweepRun r;
+        r.avgWait = st.avgWaitTime;
+        r.p95Wait = st.p95Wait;
+        r.utilisation = st.utilisation;
+        r.makespan = timeToSec(pm.currentTime);
+        r.onTimePct = st.onTimePct;
+        r.rejectedPct = gen.produced() > 0 ? 100.0 * st.rejected / gen.produced() : 0.0;
+        return r;
+    }
+
+    std::vector<SweepResult> run() const {
+        std::vector<SweepPoint> pts = config.points();
+        int reps = std::max(1, config.replications);
+        size_t total = pts.size() * (size_t)reps;
+        std::vector<SweepRun> runs(total);
+
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> finished{0};
+        auto work = [&]() {
+            for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < total;) {
+                runs[i] = runOnce(pts[i / reps], seedFor((int)(i % reps)));
+                size_t n = finished.fetch_add(1, std::memory_order_relaxed) + 1;
+                if (onProgress) onProgress(n, total);
+            }
+        };
+        unsigned n = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+        n = (unsigned)std::min<size_t>(n, std::max<size_t>(total, 1));
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < n; ++t) pool.emplace_back(work);
+        work();   // 调用线程也参与
+        for (auto& t : pool) t.join();
+
+        std::vector<SweepResult> out;
+        out.reserve(pts.size());
+        std::vector<double> wait(reps), p95(reps), util(reps), span(reps), onTime(reps), rejected(reps);
+        for (size_t p = 0; p < pts.size(); ++p) {
+            for (int r = 0; r < reps; ++r) {
+                const SweepRun& x = runs[p * reps + r];
+                wait[r] = x.avgWait;
+                p95[r] = x.p95Wait;
+                util[r] = x.utilisation;
+                span[r] = x.makespan;
+                onTime[r] = x.onTimePct;
+                rejected[r] = x.rejectedPct;
+            }
+            SweepResult res;
+            res.point = pts[p];
+            res.avgWait = Estimate::of(wait);
+            res.p95Wait = Estimate::of(p95);
+            res.utilisation = Estimate::of(util);
+            res.makespan = Estimate::of(span);
+            res.onTimePct = Estimate::of(onTime);
+            res.rejectedPct = Estimate::of(rejected);
+            out.push_back(res);
+        }
+        return out;
+    }
+};
+
+#endif // SWEEP_H
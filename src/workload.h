@@ -0,0 +1,309 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "printmanager.h"
+
+// 合成工作负载：到达过程 × 页数分布 × 用户组合，逐个生成任务（不预先生成整批）。
+//
+// 规格用一行 key=value 文本描述（逗号分隔），便于在命令行和界面上输入，例如
+//   seed=7,jobs=1000000,arrival=mmpp,rate=0.2,burst=3,calm=900,burstlen=120,
+//   group=stu,weight=3,users=500,zipf=1.2,pages=pareto:1.6:1,max=200,
+//   group=staff,weight=1,users=50,pages=lognormal:2.5:1,prio=3-6
+// 全局键：
+//   seed      随机种子（同一规格 + 种子在任何平台上生成相同序列）
+//   jobs      任务总数，0 表示不限（只能分段运行或中止）
+//   start     第一个任务可到达的最早时刻（秒）
+//   arrival   poisson | mmpp
+//   rate      平均每秒到达数（mmpp 为平静期的到达率）
+//   burst     mmpp 突发期的到达率
+//   calm      mmpp 平静期的平均持续秒数
+//   burstlen  mmpp 突发期的平均持续秒数
+// 用户组键（作用于最近一个 group=，没有 group= 时作用于默认组 user）：
+//   group     开始一个新用户组，值为用户名前缀
+//   weight    该组任务所占的相对比例
+//   users     组内用户数（用户名为 前缀1..前缀N）
+//   zipf      组内用户活跃度的 Zipf 指数，0 为均匀
+//   pages     uniform:最小:最大 | pareto:形状:最小值 | lognormal:mu:sigma
+//   max       页数上限（截断重尾）
+//   prio      优先级区间 a-b，或单个值
+//   deadline  截止时刻为提交后多少秒，0 表示没有（默认）
+
+// 页数分布
+struct PageDist {
+    enum Kind { Uniform, Pareto, Lognormal } kind = Uniform;
+    double a = 1.0;    // Uniform: 最小值；Pareto: 形状 alpha；Lognormal: mu
+    double b = 10.0;   // Uniform: 最大值；Pareto: 最小值 xm；Lognormal: sigma
+    int maxPages = 1000;
+};
+
+struct UserGroup {
+    std::string prefix = "user";
+    double weight = 1.0;
+    int users = 10;
+    double zipf = 0.0;
+    PageDist pages;
+    int minPriority = 0;
+    int maxPriority = 0;
+    double deadlineSec = 0.0;   // 相对提交时刻，0 为没有截止时刻
+};
+
+struct WorkloadSpec {
+    enum Arrival { Poisson, Mmpp };
+
+    uint64_t seed = 1;
+    long long jobs = 1000;
+    SimTime startTime = 0;        // 微秒
+    Arrival arrival = Poisson;
+    double rate = 0.1;
+    double burstRate = 1.0;
+    double calmSec = 600.0;
+    double burstSec = 60.0;
+    std::vector<UserGroup> groups = std::vector<UserGroup>(1);
+
+    // 解析规格文本；出错时返回 false 并在 err 中说明
+    static bool parse(std::string_view text, WorkloadSpec& out, std::string* err = nullptr) {
+        WorkloadSpec w;
+        bool explicitGroup = false;
+        auto fail = [err](std::string_view item, const char* why) {
+            if (err) *err = std::string(item) + ": " + why;
+            return false;
+        };
+        while (!text.empty()) {
+            size_t comma = text.find(',');
+            std::string_view item = text.substr(0, comma);
+            text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1);
+            item = trim(item);
+            if (item.empty()) continue;
+            size_t eq = item.find('=');
+            if (eq == std::string_view::npos) return fail(item, "缺少 '='");
+            std::string_view key = trim(item.substr(0, eq));
+            std::string val(trim(item.substr(eq + 1)));
+            double num = std::atof(val.c_str());
+            UserGroup& g = w.groups.back();
+
+            if (key == "seed") w.seed = std::strtoull(val.c_str(), nullptr, 10);
+            else if (key == "jobs") w.jobs = std::atoll(val.c_str());
+            else if (key == "start") w.startTime = secToTime(std::atof(val.c_str()));
+            else if (key == "arrival") {
+                if (val == "poisson") w.arrival = Poisson;
+                else if (val == "mmpp") w.arrival = Mmpp;
+                else return fail(item, "应为 poisson 或 mmpp");
+            }
+            else if (key == "rate") w.rate = num;
+            else if (key == "burst") w.burstRate = num;
+            else if (key == "calm") w.calmSec = num;
+            else if (key == "burstlen") w.burstSec = num;
+            else if (key == "group") {
+                if (explicitGroup) w.groups.emplace_back();
+                explicitGroup = true;
+                w.groups.back().prefix = val;
+            }
+            else if (key == "weight") g.weight = num;
+            else if (key == "users") g.users = std::atoi(val.c_str());
+            else if (key == "zipf") g.zipf = num;
+            else if (key == "max") g.pages.maxPages = std::atoi(val.c_str());
+            else if (key == "pages") {
+                std::vector<std::string> p = split(val, ':');
+                if (p.size() != 3) return fail(item, "应为 分布:参数1:参数2");
+                if (p[0] == "uniform") g.pages.kind = PageDist::Uniform;
+                else if (p[0] == "pareto") g.pages.kind = PageDist::Pareto;
+                else if (p[0] == "lognormal") g.pages.kind = PageDist::Lognormal;
+                else return fail(item, "分布应为 uniform、pareto 或 lognormal");
+                g.pages.a = std::atof(p[1].c_str());
+                g.pages.b = std::atof(p[2].c_str());
+            }
+            else if (key == "deadline") g.deadlineSec = num;
+            else if (key == "prio") {
+                size_t dash = val.find('-', 1);
+                g.minPriority = std::atoi(val.substr(0, dash).c_str());
+                g.maxPriority = dash == std::string::npos ? g.minPriority : std::atoi(val.substr(dash + 1).c_str());
+            }
+            else return fail(item, "未知的键");
+        }
+
+        if (w.jobs < 0) return fail("jobs", "不能为负");
+        if (w.rate < 0 || w.burstRate < 0) return fail("rate", "到达率不能为负");
+        if (w.rate <= 0 && (w.arrival == Poisson || w.burstRate <= 0)) return fail("rate", "到达率必须大于 0");
+        if (w.arrival == Mmpp && (w.calmSec <= 0 || w.burstSec <= 0)) {
+            return fail("calm/burstlen", "持续时间必须大于 0");
+        }
+        for (const auto& g : w.groups) {
+            if (g.users < 1) return fail(g.prefix, "users 必须至少为 1");
+            if (g.weight <= 0) return fail(g.prefix, "weight 必须大于 0");
+            if (g.pages.maxPages < 1) return fail(g.prefix, "max 必须至少为 1");
+            if (g.minPriority > g.maxPriority) return fail(g.prefix, "prio 区间无效");
+            if (g.deadlineSec < 0) return fail(g.prefix, "deadline 不能为负");
+            const PageDist& d = g.pages;
+            if (d.kind == PageDist::Uniform && (d.a < 1 || d.b < d.a)) return fail(g.prefix, "uniform 区间无效");
+            if (d.kind == PageDist::Pareto && (d.a <= 0 || d.b <= 0)) return fail(g.prefix, "pareto 参数必须大于 0");
+            if (d.kind == PageDist::Lognormal && d.b < 0) return fail(g.prefix, "lognormal 的 sigma 不能为负");
+        }
+        out = std::move(w);
+        return true;
+    }
+
+private:
+    static std::string_view trim(std::string_view s) {
+        while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+        while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+        return s;
+    }
+    static std::vector<std::string> split(const std::string& s, char sep) {
+        std::vector<std::string> out;
+        size_t from = 0;
+        for (;;) {
+            size_t at = s.find(sep, from);
+            out.push_back(s.substr(from, at == std::string::npos ? std::string::npos : at - from));
+            if (at == std::string::npos) return out;
+            from = at + 1;
+        }
+    }
+};
+
+// 按规格逐个生成任务，提交时刻单调不减。状态只有随机数发生器、到达过程的
+// 当前时刻和各组的 Zipf 累积分布，与已生成的任务数无关。
+// 不使用 std:: 的分布类（各标准库实现不同），均由 64 位均匀数变换得到。
+class WorkloadGenerator {
+public:
+    explicit WorkloadGenerator(const WorkloadSpec& s)
+        : spec(s), state(s.seed ? s.seed : 0x9E3779B97F4A7C15ULL) {
+        double total = 0.0;
+        for (const auto& g : spec.groups) {
+            total += g.weight;
+            groupCdf.push_back(total);
+
+            Group st;
+            st.cdf.reserve(g.users);
+            double acc = 0.0;
+            for (int u = 1; u <= g.users; ++u) {
+                acc += g.zipf > 0 ? 1.0 / std::pow((double)u, g.zipf) : 1.0;
+                st.cdf.push_back(acc);
+            }
+            st.ids.assign(g.users, 0);
+            groups.push_back(std::move(st));
+        }
+        if (spec.arrival == WorkloadSpec::Mmpp) stateEnd = exponential(1.0 / spec.calmSec);
+    }
+
+    long long produced() const { return count; }
+
+    bool next(JobSpec& out) {
+        if (spec.jobs > 0 && count >= spec.jobs) return false;
+        clock += interarrival();
+        out.submitTime = spec.startTime + secToTime(clock);
+
+        size_t gi = pick(groupCdf);
+        const UserGroup& g = spec.groups[gi];
+        Group& st = groups[gi];
+        size_t u = pick(st.cdf);
+        if (st.ids[u] == 0) {
+            st.ids[u] = StringPool::global().internUser(g.prefix + std::to_string(u + 1));
+        }
+        out.user = st.ids[u];
+
+        out.doc = catalogue()[(size_t)(uniform() * kDocs)];
+
+        out.pages = pages(g.pages);
+        out.priority = g.minPriority
+                     + (int)(uniform() * (g.maxPriority - g.minPriority + 1));
+        out.deadline = g.deadlineSec > 0 ? out.submitTime + secToTime(g.deadlineSec) : -1;
+        ++count;
+        return true;
+    }
+
+private:
+    static constexpr size_t kDocs = 1024;
+
+    // 文档名目录 doc1.pdf .. doc1024.pdf：全进程共用，只写入字符串池一次
+    // （参数扫描会并行创建大量生成器）
+    static const std::vector<DocRef>& catalogue() {
+        static const std::vector<DocRef> docs = []() {
+            std::vector<DocRef> v;
+            v.reserve(kDocs);
+            for (size_t d = 0; d < kDocs; ++d) {
+                v.push_back(StringPool::global().addDoc("doc" + std::to_string(d + 1) + ".pdf"));
+            }
+            return v;
+        }();
+        return docs;
+    }
+
+    struct Group {
+        std::vector<double> cdf;      // 组内用户的累积权重
+        std::vector<UserId> ids;      // 用户名编号，首次用到时驻留
+    };
+
+    // splitmix64：状态 64 位，序列与平台无关
+    uint64_t bits() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    double uniform() { return (bits() >> 11) * (1.0 / 9007199254740992.0); }   // [0, 1)
+    double exponential(double rate) {
+        if (rate <= 0) return std::numeric_limits<double>::infinity();
+        return -std::log1p(-uniform()) / rate;
+    }
+    double normal() {   // Box-Muller
+        double u1 = 1.0 - uniform(), u2 = uniform();
+        return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+    }
+
+    // 按累积权重取下标
+    size_t pick(const std::vector<double>& cdf) {
+        double x = uniform() * cdf.back();
+        size_t i = std::upper_bound(cdf.begin(), cdf.end(), x) - cdf.begin();
+        return std::min(i, cdf.size() - 1);
+    }
+
+    // 到下一个任务的间隔（秒）。MMPP：两个状态各自为泊松到达，状态持续时间服从指数分布；
+    // 指数分布无记忆，跨过状态切换点时从切换点重新抽样即可
+    double interarrival() {
+        if (spec.arrival == WorkloadSpec::Poisson) return exponential(spec.rate);
+        double from = clock, t = clock;
+        for (;;) {
+            double dt = exponential(bursting ? spec.burstRate : spec.rate);
+            if (t + dt < stateEnd) return t + dt - from;
+            t = stateEnd;
+            bursting = !bursting;
+            stateEnd = t + exponential(1.0 / (bursting ? spec.burstSec : spec.calmSec));
+        }
+    }
+
+    int pages(const PageDist& d) {
+        double x = 1.0;
+        switch (d.kind) {
+        case PageDist::Uniform:
+            x = std::floor(d.a + uniform() * (std::floor(d.b) - d.a + 1));
+            break;
+        case PageDist::Pareto:
+            x = std::ceil(d.b / std::pow(1.0 - uniform(), 1.0 / d.a));
+            break;
+        case PageDist::Lognormal:
+            x = std::ceil(std::exp(d.a + d.b * normal()));
+            break;
+        }
+        if (!(x >= 1.0)) x = 1.0;
+        return (int)std::min<double>(x, d.maxPages);
+    }
+
+    WorkloadSpec spec;
+    uint64_t state;
+    double clock = 0.0;           // 相对 startTime 的到达时刻
+    bool bursting = false;        // MMPP 当前是否处于突发期
+    double stateEnd = 0.0;        // MMPP 当前状态结束的时刻
+    long long count = 0;
+    std::vector<double> groupCdf;
+    std::vector<Group> groups;
+};
+
+#endif // WORKLOAD_H
@@ -0,0 +1,98 @@
+// 准入控制的回归测试：预约任务在到达时按那时的积压判断（队列长度上限、截止时刻），
+// 同一时刻到达的一批与逐个立即提交的结果相同。
+//
+// 用法: PrintManagerAdmissionTests [admission]
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "printmanager.h"
+#include "testing.h"
+
+// ========== 用例 ==========
+
+// 轨迹：100 个 10 页的任务，每秒到达一个（整个轨迹在 t = 0 一次提交，任务在各自的时刻到达）
+static std::vector<JobSpec> trace(SimTime deadlineAfter)
+{
+    std::vector<JobSpec> specs(100);
+    for (int i = 0; i < 100; ++i) {
+        specs[i].user = StringPool::global().internUser("trace");
+        specs[i].doc = StringPool::global().addDoc("job" + std::to_string(i));
+        specs[i].pages = 10;
+        specs[i].submitTime = secToTime(i);
+        specs[i].deadline = deadlineAfter >= 0 ? specs[i].submitTime + deadlineAfter : -1;
+    }
+    return specs;
+}
+
+static void testAdmission()
+{
+    // 队列长度上限 5：打印机 20 秒打一个，队列满之后每 20 秒只放进一个
+    {
+        PrintManager pm;
+        pm.persist = false;
+        pm.setAdmission(AdmissionPolicy::Reject, 5);
+        pm.addJobs(trace(-1));
+        CHECK(pm.rejectCount == 0);   // 提交时还都没到达
+        pm.runToEnd();
+        CHECK(pm.rejectCount == 90);
+        CHECK(pm.done.size() == 10);
+    }
+    // 截止时刻为到达后 60 秒：预计赶不上的拒绝，接收的全部按时完成
+    {
+        PrintManager pm;
+        pm.persist = false;
+        pm.setAdmission(AdmissionPolicy::Reject, 0);
+        pm.addJobs(trace(secToTime(60)));
+        pm.runToEnd();
+        auto s = pm.getStatistics();
+        CHECK(pm.rejectCount > 0);
+        CHECK(s.deadlineJobs == 100 - pm.rejectCount);
+        CHECK(s.onTimePct == 100.0);
+    }
+    // 同一时刻到达的一批预约任务按入队前的积压判断，结果与到时刻再逐个立即提交相同
+    auto sameInstant = [](int jobs, int limit, SimTime deadlineAfter) {
+        PrintManager scheduled, immediate;
+        for (PrintManager* pm : {&scheduled, &immediate}) {
+            pm->persist = false;
+            pm->setAdmission(AdmissionPolicy::Reject, limit);
+        }
+        SimTime at = secToTime(10);
+        SimTime deadline = deadlineAfter >= 0 ? at + deadlineAfter : -1;
+        for (int i = 0; i < jobs; ++i) scheduled.addJobAt("s", "d", 10, at, 0, deadline);
+        scheduled.advance(at, false);
+        immediate.advance(at, false);
+        for (int i = 0; i < jobs; ++i) immediate.addJob("s", "d", 10, 0, deadline);
+        return std::make_pair(scheduled.rejectCount, immediate.rejectCount);
+    };
+    {
+        auto r = sameInstant(4, 4, -1);
+        CHECK(r.first == 0 && r.second == 0);
+        r = sameInstant(8, 0, secToTime(100));
+        CHECK(r.first == r.second);
+        CHECK(r.first == 3);   // 2 秒/页：第 k 个任务在 20k 秒后完成，前 5 个赶得上
+    }
+    // 降级：全部接收，赶不上的降到 kDemotedPriority
+    {
+        PrintManager pm;
+        pm.persist = false;
+        pm.setDiscipline(QueueDiscipline::Priority);
+        pm.setAdmission(AdmissionPolicy::Demote, 0);
+        pm.addJobs(trace(secToTime(60)));
+        pm.runToEnd();
+        CHECK(pm.rejectCount == 0);
+        CHECK(pm.demoteCount > 0);
+        CHECK(pm.done.size() == 100);
+    }
+}
+
+// ========== 入口 ==========
+
+static const TestCase kTests[] = {
+    {"admission", testAdmission},
+};
+
+int main(int argc, char** argv)
+{
+    return runTests(argc, argv, kTests);
+}
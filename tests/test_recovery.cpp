@@ -0,0 +1,208 @@
+// 崩溃恢复的回归测试：随机操作（抢占、拆分、暂停、调度策略、准入控制、批量提交）之后
+// 从快照 + 日志恢复，状态与崩溃前一致。
+//
+// 用法: PrintManagerRecoveryTests [replay]
+
+#include <random>
+#include <string>
+#include <vector>
+#include "printmanager.h"
+#include "testing.h"
+
+// 新建一个写到 test_data/ 下的引擎（目录先清空）；每个事件都落盘，便于随时“崩溃”
+static void configure(PrintManager& pm)
+{
+    std::error_code ec;
+    std::filesystem::remove_all(kDataDir, ec);
+    std::filesystem::create_directories(kDataDir);
+    pm.setDataDir(kDataDir);
+    pm.journal.durability = Journal::Durability::EveryEvent;
+    pm.saveAll();
+}
+
+// 两个引擎的可观察状态是否一致；不一致时打印第一处差异
+static bool sameState(PrintManager& a, PrintManager& b)
+{
+    auto differ = [](const char* what) {
+        std::fprintf(stderr, "状态不一致: %s\n", what);
+        return false;
+    };
+    if (a.currentTime != b.currentTime) return differ("时钟");
+    if (a.nextId != b.nextId) return differ("下一个 ID");
+    if (a.secPerPage != b.secPerPage || a.policy != b.policy || a.preempt != b.preempt) return differ("设置");
+    if (a.discipline != b.discipline || a.waitQ.discipline != b.waitQ.discipline) return differ("排队规则");
+    if (a.admission != b.admission || a.queueLimit != b.queueLimit) return differ("准入控制");
+    if (a.pending.size() != b.pending.size()) return differ("预约任务");
+
+    if (a.printers.size() != b.printers.size()) return differ("打印机数量");
+    for (size_t i = 0; i < a.printers.size(); ++i) {
+        const Printer& x = a.printers[i];
+        const Printer& y = b.printers[i];
+        if (x.busy != y.busy || x.secPerPage != y.secPerPage || x.busyTime != y.busyTime ||
+            x.jobsDone != y.jobsDone || x.pagesDone != y.pagesDone) return differ("打印机");
+        if (x.busy && (x.remain != y.remain || x.current.id != y.current.id ||
+                       x.current.donePages != y.current.donePages)) return differ("正在打印的任务");
+    }
+
+    auto wa = a.getWaitingJobs();
+    auto wb = b.getWaitingJobs();
+    if (wa.size() != wb.size()) return differ("等待队列长度");
+    for (size_t i = 0; i < wa.size(); ++i) {
+        if (wa[i].id != wb[i].id || wa[i].priority != wb[i].priority || wa[i].donePages != wb[i].donePages ||
+            wa[i].parent != wb[i].parent || wa[i].deadline != wb[i].deadline ||
+            wa[i].userName() != wb[i].userName()) return differ("等待队列");
+    }
+
+    if (a.done.size() != b.done.size()) return differ("完成记录条数");
+    for (size_t i = 0; i < a.done.size(); ++i) {
+        if (a.done[i].id != b.done[i].id || a.done[i].startTime != b.done[i].startTime ||
+            a.done[i].finishTime != b.done[i].finishTime || a.done[i].docName() != b.done[i].docName()) {
+            return differ("完成记录");
+        }
+    }
+    if (a.doneStats.wait.n != b.doneStats.wait.n || a.doneStats.wait.mean != b.doneStats.wait.mean ||
+        a.doneStats.onTime != b.doneStats.onTime) return differ("完成统计");
+
+    if (a.held.size() != b.held.size()) return differ("暂停的任务");
+    for (const auto& h : a.held) {
+        auto it = b.held.find(h.first);
+        if (it == b.held.end() || it->second.donePages != h.second.donePages) return differ("暂停的任务");
+    }
+    if (a.splits.size() != b.splits.size()) return differ("拆分任务");
+    for (const auto& s : a.splits) {
+        auto it = b.splits.find(s.first);
+        if (it == b.splits.end() || it->second.left != s.second.left || it->second.chunks != s.second.chunks) {
+            return differ("拆分任务");
+        }
+    }
+    return true;
+}
+
+// 恢复后立即比较：队列、预约任务、暂停和拆分任务必须已经一致。
+// 时钟和正在打印的任务的剩余时间可以落后（空转的推进不一定记日志），其余部分留给推进后比较
+static bool sameQueues(PrintManager& a, PrintManager& b)
+{
+    auto differ = [](const char* what) {
+        std::fprintf(stderr, "恢复后立即比较不一致: %s\n", what);
+        return false;
+    };
+    if (b.currentTime > a.currentTime) return differ("时钟超前");
+    if (a.nextId != b.nextId) return differ("下一个 ID");
+    if (a.pending.size() != b.pending.size()) return differ("预约任务");
+    auto wa = a.getWaitingJobs();
+    auto wb = b.getWaitingJobs();
+    if (wa.size() != wb.size()) return differ("等待队列长度");
+    for (size_t i = 0; i < wa.size(); ++i) {
+        if (wa[i].id != wb[i].id || wa[i].priority != wb[i].priority) return differ("等待队列");
+    }
+    for (size_t i = 0; i < a.printers.size() && i < b.printers.size(); ++i) {
+        if (a.printers[i].busy != b.printers[i].busy ||
+            (a.printers[i].busy && a.printers[i].current.id != b.printers[i].current.id)) return differ("正在打印的任务");
+    }
+    if (a.held.size() != b.held.size() || a.splits.size() != b.splits.size()) return differ("暂停/拆分任务");
+    return true;
+}
+
+// ========== 用例 ==========
+
+// 随机操作序列之后模拟崩溃：新实例从快照 + 日志恢复，先立即比较队列，
+// 再推进到崩溃时刻比较全部状态（其间没有任何事件，结果应完全相同），最后两边都跑完再比较
+static void replayTrials(unsigned seed, int trials)
+{
+    std::mt19937 rng(seed);
+    const char* users[] = {"alice", "bob", "u,\"q\"\nx"};
+    for (int trial = 0; trial < trials; ++trial) {
+        PrintManager a;
+        configure(a);
+        a.snapshotEvery = 1 + rng() % 40;
+        a.setPreemption(rng() % 2);
+        if (rng() % 2) a.setDiscipline((QueueDiscipline)(1 + rng() % 4), 0.05);
+        int ops = rng() % 80;
+        for (int op = 0; op < ops; ++op) {
+            int r = rng() % 20;
+            if (r < 4) {
+                SimTime deadline = rng() % 2 ? -1 : a.currentTime + (SimTime)(rng() % 200000000);
+                a.addJob(users[rng() % 3], "doc", 1 + rng() % (rng() % 3 ? 20 : 120), rng() % 10, deadline);
+            } else if (r < 5) {
+                a.cancelJob(1 + rng() % 30);
+            } else if (r < 6) {
+                a.setSpeed(0.013 + (rng() % 30) / 10.0);
+            } else if (r < 7) {
+                a.addJobAt("future", "doc", 3, a.currentTime + rng() % 20000000);
+            } else if (r < 10) {
+                a.tick((1 + rng() % 150) / 10.0);
+            } else if (r < 11) {
+                a.setPrinterCount(1 + rng() % 4);
+            } else if (r < 12) {
+                a.setPrinterSpeed(rng() % 4, 0.5 + rng() % 3);
+            } else if (r < 13) {
+                if (rng() % 2) a.setPolicy((DispatchPolicy)(rng() % 4));
+                else a.setDiscipline((QueueDiscipline)(rng() % 5), (rng() % 3) * 0.05);
+            } else if (r < 14) {
+                std::vector<JobSpec> specs(rng() % 50);
+                for (auto& s : specs) {
+                    s.user = StringPool::global().internUser(users[rng() % 3]);
+                    s.doc = StringPool::global().addDoc("bulk");
+                    s.pages = 1 + rng() % 60;
+                    s.submitTime = a.currentTime + (rng() % 2 ? 0 : (SimTime)(rng() % 5000000));
+                    s.priority = rng() % 3;
+                    s.deadline = rng() % 2 ? -1 : s.submitTime + (SimTime)(rng() % 100000000);
+                }
+                a.addJobs(specs);
+            } else if (r < 15) {
+                if (rng() % 2) a.setPreemption(rng() % 3 != 0);
+                else a.setSplitPages(rng() % 3 ? 0 : 1 + rng() % 30);
+            } else if (r < 16) {
+                int id = 1 + rng() % 40;
+                for (const auto& p : a.printers) {
+                    if (p.busy && rng() % 2) id = p.current.id;
+                }
+                a.pauseJob(id);
+            } else if (r < 17) {
+                if (!a.held.empty()) a.resumeJob(a.held.begin()->first);
+            } else if (r < 18) {
+                a.cancelUserJobs(users[rng() % 3]);
+            } else if (r < 19) {
+                a.setAdmission((AdmissionPolicy)(rng() % 3), rng() % 3 ? 0 : 1 + rng() % 10);
+            } else {
+                a.runToEnd();
+            }
+        }
+        a.journal.flush(true);
+
+        PrintManager b;
+        b.setDataDir(kDataDir);
+        b.load();
+        bool ok = sameQueues(a, b);
+        if (ok) {
+            if (b.currentTime < a.currentTime) b.advance(a.currentTime, false);
+            ok = sameState(a, b);
+        }
+        if (ok) {
+            a.runToEnd();
+            b.runToEnd();
+            ok = sameState(a, b);
+        }
+        if (!ok) std::fprintf(stderr, "种子 %u，第 %d 轮\n", seed, trial);
+        CHECK(ok);
+    }
+}
+
+static void testReplay()
+{
+    for (unsigned seed : {1u, 3u, 9u, 31u}) {
+        replayTrials(seed, 300);
+        if (g_failures) return;
+    }
+}
+
+// ========== 入口 ==========
+
+static const TestCase kTests[] = {
+    {"replay", testReplay},
+};
+
+int main(int argc, char** argv)
+{
+    return runTests(argc, argv, kTests);
+}
@@ -0,0 +1,79 @@
+// 等待队列的回归测试：变化记录（界面的等待表格据此增量刷新）按序应用后，
+// 按 (compareJobs, 入队序号) 排序的副本与 ordered() 的出队顺序一致。
+//
+// 用法: PrintManagerQueueTests [queue]
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "printmanager.h"
+#include "testing.h"
+
+// ========== 用例 ==========
+
+// 随机增删、切换规则，把变化记录应用到按 (compareJobs, 入队序号) 排序的副本上，与 ordered() 比较
+static void testQueueChanges()
+{
+    struct Entry {
+        unsigned long long seq;
+        PrintJob job;
+    };
+    std::mt19937 rng(5);
+    JobQueue q;
+    q.trackChanges = true;
+    std::vector<Entry> mirror;
+    int nextId = 1;
+    for (int round = 0; round < 2000; ++round) {
+        int op = rng() % 10;
+        if (op < 5) {
+            for (int k = 1 + rng() % 5; k > 0; --k) {
+                PrintJob j;
+                j.id = nextId++;
+                j.pages = 1 + rng() % 30;
+                j.priority = rng() % 5;
+                j.submitTime = secToTime(round);
+                q.push(j);
+            }
+        } else if (op < 8) {
+            if (!q.empty()) q.remove(q.ordered()[rng() % q.size()].id);
+        } else if (op < 9) {
+            int m = rng() % 4;
+            q.removeIf([m](const PrintJob& j) { return j.pages % 4 == m; });
+        } else {
+            q.setDiscipline((QueueDiscipline)(rng() % 5), 1e-6);
+        }
+
+        if (q.changesLost) {
+            mirror.clear();
+            q.resyncChanges([&](const PrintJob& j, unsigned long long seq) { mirror.push_back({seq, j}); });
+        } else {
+            for (const auto& c : q.changes) {
+                if (c.seq == 0) {
+                    mirror.erase(std::find_if(mirror.begin(), mirror.end(),
+                                              [&](const Entry& e) { return e.job.id == c.id; }));
+                } else {
+                    mirror.push_back({c.seq, *q.find(c.id)});
+                }
+            }
+            q.changes.clear();
+        }
+        std::stable_sort(mirror.begin(), mirror.end(), [&](const Entry& x, const Entry& y) {
+            int cmp = compareJobs(q.discipline, q.agingRate, x.job, y.job);
+            return cmp != 0 ? cmp < 0 : x.seq < y.seq;
+        });
+        auto want = q.ordered();
+        CHECK(mirror.size() == want.size());
+        for (size_t i = 0; i < want.size(); ++i) CHECK(mirror[i].job.id == want[i].id);
+    }
+}
+
+// ========== 入口 ==========
+
+static const TestCase kTests[] = {
+    {"queue", testQueueChanges},
+};
+
+int main(int argc, char** argv)
+{
+    return runTests(argc, argv, kTests);
+}
@@ -0,0 +1,54 @@
+#ifndef PRINTMANAGER_TESTING_H
+#define PRINTMANAGER_TESTING_H
+
+// 回归测试的公共部分（由 ctest 运行）。不依赖第三方库：每个用例是一个函数，
+// CHECK 失败时打印位置并记为失败；命令行参数为用例名，省略时运行全部用例。
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+inline int g_failures = 0;
+
+#define CHECK(cond)                                                                 \
+    do {                                                                            \
+        if (!(cond)) {                                                              \
+            std::fprintf(stderr, "%s:%d: 检查失败: %s\n", __FILE__, __LINE__, #cond); \
+            ++g_failures;                                                           \
+            return;                                                                 \
+        }                                                                           \
+    } while (0)
+
+// 需要写文件的用例把数据目录放在工作目录下（ctest 为每个用例单独指定工作目录）
+inline const char* kDataDir = "test_data";
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+// 运行 argv 中点名的用例（省略时全部运行），返回进程退出码
+template <size_t N>
+int runTests(int argc, char** argv, const TestCase (&tests)[N])
+{
+    int ran = 0;
+    for (const TestCase& t : tests) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i) selected = selected || std::strcmp(argv[i], t.name) == 0;
+        if (!selected) continue;
+        int before = g_failures;
+        t.run();
+        std::printf("%-10s %s\n", t.name, g_failures == before ? "ok" : "FAILED");
+        ++ran;
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(kDataDir, ec);
+    if (ran == 0) {
+        std::fprintf(stderr, "没有匹配的用例\n");
+        return 2;
+    }
+    return g_failures == 0 ? 0 : 1;
+}
+
+#endif // PRINTMANAGER_TESTING_H